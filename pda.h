@@ -2,35 +2,320 @@
 #define PDA_H
 
 
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <type_traits>
+
+#include "pda_simd.h"
+#include "pda_stack.h"
+
 // Typedefs for comparator/destructor functions
 typedef int (*comparatorF)(void*, void*);
 typedef void* (*copyF)(void*);
 typedef std::string (*toStringF)(void*);
 typedef void (*destructorF)(void*);
 
+// Class table entry for elements that are neither the escape nor a delimiter
+const unsigned int PDA_PLAIN = 0xFFFFFFFF;
+
+// Source offsets kept in bulk, such as in token tables
+// Define PDA_COMPACT_OFFSETS to store them in 32 bits when no source is larger than 4 GiB
+#ifdef PDA_COMPACT_OFFSETS
+typedef unsigned int pdaOffset;
+#else
+typedef size_t pdaOffset;
+#endif
+
+
+/************************************************
+ * Non-owning view of a run of elements
+ * Tokens are handed out as views into the source
+ * so that reading them does not copy anything
+ ************************************************/
+template <typename T>
+class PDASpan
+{
+	private:
+		const T* first;                  // First element in view
+		size_t count;                    // Number of elements in view
+		
+	public:
+		/* Constructors */
+		PDASpan()
+		{
+			this->first = NULL;
+			this->count = 0;
+		};
+		
+		PDASpan(const T* f, size_t c)
+		{
+			this->first = f;
+			this->count = c;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		const T* data() const
+		{
+			return this->first;
+		};
+		
+		size_t size() const
+		{
+			return this->count;
+		};
+		
+		bool empty() const
+		{
+			return this->count == 0;
+		};
+		
+		const T* begin() const
+		{
+			return this->first;
+		};
+		
+		const T* end() const
+		{
+			return this->first + this->count;
+		};
+		
+		const T& operator[](size_t i) const
+		{
+			return this->first[i];
+		};
+		
+		// Copy the viewed elements for callers that need ownership
+		std::vector<T> toVector() const
+		{
+			return std::vector<T>(this->begin(), this->end());
+		};
+};
+
+
+/************************************************
+ * Columnar table of tokens filled by tokenizeAll()
+ * Row i is the token source[start[i], start[i] + length[i]),
+ * ended by the delimiter at index delim[i] of pairs
+ * clear() keeps the capacity, so one table can be reused across sources
+ ************************************************/
+class PDATokenTable
+{
+	public:
+		std::vector<pdaOffset> start;      // Position of the first element of each token
+		std::vector<pdaOffset> length;     // Number of elements in each token
+		std::vector<unsigned int> delim;   // Index into pairs of the delimiter that ended each token
+		std::vector<pdaOffset> depth;      // Depth of the stack once that delimiter was read
+		std::vector<unsigned char> opened; // 1 if that delimiter opened a block, 0 if it closed one
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Add a row
+		void push_back(size_t s, size_t l, unsigned int d, size_t dp, bool o)
+		{
+			this->start.push_back((pdaOffset)s);
+			this->length.push_back((pdaOffset)l);
+			this->delim.push_back(d);
+			this->depth.push_back((pdaOffset)dp);
+			this->opened.push_back(o ? 1 : 0);
+		};
+		
+		// Make room for n rows
+		void reserve(size_t n)
+		{
+			this->start.reserve(n);
+			this->length.reserve(n);
+			this->delim.reserve(n);
+			this->depth.reserve(n);
+			this->opened.reserve(n);
+		};
+		
+		// Remove every row, keeping the capacity for reuse
+		void clear()
+		{
+			this->start.clear();
+			this->length.clear();
+			this->delim.clear();
+			this->depth.clear();
+			this->opened.clear();
+		};
+		
+		// Get the number of rows
+		size_t size() const
+		{
+			return this->start.size();
+		};
+};
+
+
+/************************************************
+ * Saved state of a string PDA, to resume reading from after an edit
+ ************************************************/
+class PDACheckpoint
+{
+	public:
+		pdaOffset pos;                   // Position of the automata
+		pdaOffset start;                 // Starting position of the token being read
+		bool esc;                        // True if the element at pos is escaped
+		std::vector<unsigned int> stack; // Copy of the stack, bottom first
+};
+
+
+/************************************************
+ * Event handler for parse()
+ * parse() takes the handler type as a template parameter and calls it directly,
+ * so derive from PDAHandler and hide only the events of interest
+ ************************************************/
+class PDAHandler
+{
+	public:
+		// A delimiter at index delim of pairs opened a block at pos
+		void onOpen(unsigned int /*delim*/, size_t /*pos*/) { }
+		
+		// A delimiter at index delim of pairs closed a block at pos
+		void onClose(unsigned int /*delim*/, size_t /*pos*/) { }
+		
+		// A delimiter ended a token, given as a view into the source, just before onOpen() or onClose()
+		template <typename View>
+		void onToken(const View& /*token*/) { }
+		
+		// An escape character at pos escapes the character after it
+		void onEscape(size_t /*pos*/) { }
+		
+		// The automata stopped with error code err at pos
+		void onError(int /*err*/, size_t /*pos*/) { }
+};
+
+
+/************************************************
+ * Element policies for PDA<T>
+ * Compare tells if two elements are equal, Copy copies one
+ * out of the source, ToString prints one in error messages
+ ************************************************/
+
+// Copy an element with its own copy constructor
+template <typename T>
+class PDACopy
+{
+	public:
+		T operator()(const T& e) const
+		{
+			return e;
+		};
+};
+
+// Print an element with operator<<
+template <typename T>
+class PDAToString
+{
+	public:
+		std::string operator()(const T& e) const
+		{
+			std::ostringstream out;
+			out << e;
+			return out.str();
+		};
+};
+
+// Adapters for the function pointer interface
+template <typename T>
+class PDAFnCompare
+{
+	private:
+		comparatorF f;
+		
+	public:
+		PDAFnCompare(comparatorF co = NULL)
+		{
+			this->f = co;
+		};
+		
+		bool operator()(const T& a, const T& b) const
+		{
+			return this->f((void*)&a, (void*)&b) == 0;
+		};
+};
+
+// Copies through the copy function, then frees its result with the destructor function (if any)
+template <typename T>
+class PDAFnCopy
+{
+	private:
+		copyF f;
+		destructorF d;
+		
+	public:
+		PDAFnCopy(copyF cp = NULL, destructorF de = NULL)
+		{
+			this->f = cp;
+			this->d = de;
+		};
+		
+		T operator()(const T& e) const
+		{
+			T* temp = (T*)( this->f( (void*)&e ) );
+			T out = *temp;
+			
+			if(this->d != NULL)
+				this->d( (void*)temp );
+			
+			return out;
+		};
+};
+
+template <typename T>
+class PDAFnToString
+{
+	private:
+		toStringF f;
+		
+	public:
+		PDAFnToString(toStringF ts = NULL)
+		{
+			this->f = ts;
+		};
+		
+		std::string operator()(const T& e) const
+		{
+			return this->f( (void*)&e );
+		};
+};
+
 
 /************************************************
  * Standard template T
  * General-purpose PDA
+ * Elements are compared, copied and printed through the policies,
+ * which inline; PDAFn<T> takes function pointers instead
  ************************************************/
-template <typename T>
+template <typename T, typename Compare = std::equal_to<T>, typename Copy = PDACopy<T>, typename ToString = PDAToString<T> >
 class PDA
 {
 	private:
-		std::vector<T> source;           // Source to read from (generally some kind of list or string)
-		std::vector<unsigned int> stack; // Stack used to keep track of delimiter pairs, array of indices from delimiter pairs vector
-		std::vector<T> pairs;            // Token pairs, store the escape delimiter in index 0
-		int start;                       // Starting position of valid token
-		unsigned int pos;                // Current read position of PDA
+		std::vector<T> source;           // Source to read from when the PDA owns it (generally some kind of list or string)
+		PDASpan<T> ext;                  // Source to read from when the caller owns it and keeps it alive
+		bool borrowed;                   // True if reading from ext instead of source
+		PDAStack<> stack;                // Stack used to keep track of delimiter pairs, array of indices from delimiter pairs vector
+		size_t maxDepth;                 // Most delimiters the stack may hold, opening one more is an error
+		std::vector<T> pairs;            // Token pairs, store the escape delimiter in index 0 (first element of each if longer)
+		std::vector<std::vector<T> > seqs; // Whole delimiters, only kept if one is longer than one element
+		std::vector<bool> sym;           // True for an opening delimiter that is its own closing delimiter
+		std::vector<T> needles;          // Distinct first elements of the escape and delimiters, searched for by skip()
+		size_t start;                    // Starting position of valid token
+		size_t pos;                      // Current read position of PDA
 		bool esc;                        // True if an escape character was found
 		
 		bool noisy;                      // push() and pop() output to command line when set
 		
-		// Comparator, copy, toString, and destructor functions
-		comparatorF comp;                // "less than" returns < 0; "greater than" returns > 0; "equal to" returns 0
-		copyF cpy;
-		toStringF tstr;
-		destructorF destr;
+		// Comparator, copy and toString policies
+		Compare comp;                    // True if two elements are equal
+		Copy cpy;
+		ToString tstr;
 		
 		// Error checking
 		// < 0 means error, do not continue
@@ -39,6 +324,12 @@ class PDA
 		// Index of last opening delimiter popped
 		unsigned int odelim;
 		
+		// Elements copied as bytes: trivially copyable, with the default Copy policy
+		static constexpr bool flat = std::is_trivially_copyable<T>::value && std::is_same<Copy, PDACopy<T> >::value;
+		
+		// Elements compared as bytes: integers or enums compared with operator==, whose equality is that of their bytes
+		static constexpr bool raw = flat && (std::is_integral<T>::value || std::is_enum<T>::value) && std::is_same<Compare, std::equal_to<T> >::value;
+		
 		// Private default constructor
 		PDA() { }
 		
@@ -56,7 +347,7 @@ class PDA
 			if(this->noisy)
 			{
 				std::cout << "after push at " << this->pos << " [";
-				for(unsigned int i = 0; i < this->stack.size(); i++)
+				for(size_t i = 0; i < this->stack.size(); i++)
 				{
 					std::cout << this->stack[i] << ", ";
 				}
@@ -81,7 +372,7 @@ class PDA
 			if(this->noisy)
 			{
 				std::cout << "After pop() at " << this->pos << " [";
-				for(unsigned int i = 0; i < this->stack.size(); i++)
+				for(size_t i = 0; i < this->stack.size(); i++)
 				{
 					std::cout << this->stack[i] << ", ";
 				}
@@ -89,49 +380,125 @@ class PDA
 			}
 		};
 		
-	public:
-		/* Constructor */
-		PDA(std::vector<T> src, std::vector<T> p, comparatorF co, copyF cp, toStringF ts, destructorF de, bool n)
+		/* Source */
+		
+		// Get the source being read, whoever owns it
+		PDASpan<T> src()
 		{
-			// Load info
-			this->source = src;
-			this->pairs = p;
-			this->noisy = n;
-			
-			// Stack... is already initialized to an empty vector
+			if(this->borrowed)
+				return this->ext;
 			
-			// Tracking
-			this->start = 0;
-			this->pos = 0;
-			this->esc = false;
+			return PDASpan<T>(this->source.data(), this->source.size());
+		};
+		
+		/* Tokens */
+		
+		// Copy len elements of source, starting at from, into a new vector
+		std::vector<T> copyPortion(size_t from, size_t len)
+		{
+			std::vector<T> out;
+			this->copyPortion(from, len, out);
 			
-			// Comparator, copy, toString, and destructor functions
-			this->comp = co;
-			this->cpy = cp;
-			this->tstr = ts;
-			this->destr = de;
+			return out;
+		};
+		
+		// Copy len elements of source, starting at from, over out, reusing its capacity
+		void copyPortion(size_t from, size_t len, std::vector<T>& out)
+		{
+			const T* s = this->src().data() + from;
 			
-			// Error codes
-			this->err = 0;
+			// One bulk copy, assign() moves trivially copyable elements with memmove()
+			if constexpr(flat)
+			{
+				out.assign(s, s + len);
+				return;
+			}
 			
-			// Delimiter index
-			this->odelim = 0;
+			out.clear();
+			out.reserve(len);
+			for(size_t i = 0; i < len; i++)
+			{
+				// Add to output vector
+				out.push_back( this->cpy(s[i]) );
+			}
 		};
 		
-		/*******************************************
-		 * Functions
-		 *******************************************/
+		/* Delimiters */
 		
-		/* Traverse automata */
+		// Get a delimiter as a view, to report it
+		PDASpan<T> text(unsigned int i)
+		{
+			if(this->seqs.empty())
+				return PDASpan<T>(&this->pairs[i], 1);
+			
+			return PDASpan<T>(this->seqs[i].data(), this->seqs[i].size());
+		};
 		
-		// Read next element from source
-		std::vector<T> readNext()
+		// Get the length of the longest escape or delimiter at the current position, 0 if there is none, and its index into pairs
+		// Elements can only be compared for equality, so with delimiters longer than one element each one is tried in turn
+		size_t match(unsigned int& index)
 		{
-			std::vector<T> out;
+			PDASpan<T> s = this->src();
+			size_t best = 0;
 			
+			if(this->seqs.empty())
+			{
+				// Lower indices win
+				for(unsigned int i = 0; i < this->pairs.size(); i++)
+				{
+					if( this->comp( s[this->pos], this->pairs[i] ) )
+					{
+						index = i;
+						return 1;
+					}
+				}
+				
+				return 0;
+			}
+			
+			for(unsigned int i = 0; i < this->seqs.size(); i++)
+			{
+				size_t w = this->seqs[i].size();
+				
+				// Longer matches win, then lower indices
+				if(w <= best || w > s.size() - this->pos)
+					continue;
+				
+				if constexpr(raw)
+				{
+					if(std::memcmp(s.data() + this->pos, this->seqs[i].data(), w * sizeof(T)) == 0)
+					{
+						best = w;
+						index = i;
+					}
+					continue;
+				}
+				
+				size_t k = 0;
+				while(k < w && this->comp( s[this->pos + k], this->seqs[i][k] ))
+				{
+					k++;
+				}
+				
+				if(k == w)
+				{
+					best = w;
+					index = i;
+				}
+			}
+			
+			return best;
+		};
+		
+		/* Transitions */
+		
+		// Read next element from source and move the automata along
+		// Returns true if a delimiter closed a token, which is then source[from, from + len)
+		bool step(size_t& from, size_t& len)
+		{
 			// Do not proceed if error code is set or end of source is reached
-			if(this->err < 0 || this->pos > this->source.size())
-				return out;
+			if(this->err < 0 || this->pos >= this->src().size())
+				return false;
 			
 			// Reset the last opening delimiter popped, assuming that the user has already accessed it
 			if(this->odelim != 0)
@@ -144,106 +511,421 @@ class PDA
 				
 				// Clean up and end
 				this->pos += 1;
-				if(this->pos >= this->source.size() && this->stack.size() > 0)
+				if(this->pos >= this->src().size() && this->stack.size() > 0)
 				{
 					// Unclosed delimiter error
 					this->err = this->noCloseErr();
 				}
-				return out;
+				return false;
 			}
 			
+			unsigned int i;
+			size_t w = this->match(i);
+			
 			// There's nothing to do if this is an escape element
-			if( this->comp( &(this->source[this->pos]), &(this->pairs[0]) ) == 0 )
+			if(w > 0 && i == 0)
 			{
 				this->esc = true;
 				
 				// Clean up and end
-				this->pos += 1;
-				if(this->pos >= this->source.size() && this->stack.size() > 0)
+				this->pos += w;
+				if(this->pos >= this->src().size() && this->stack.size() > 0)
 				{
 					// Unclosed delimiter error
 					this->err = this->noCloseErr();
 				}
-				return out;
+				return false;
 			}
 			
 			// Check for delimiters
-			for(unsigned int i = 1; i < this->pairs.size(); i++)
+			if(w > 0)
 			{
-				// Is this a delimiter?
-				if( this->comp( &(this->source[this->pos]), &(this->pairs[i]) ) == 0 )
+				// What kind of delimiter is this?
+				if(i % 2 == 1) // Opening delimiter
 				{
-					// What kind of delimiter is this?
-					if(i % 2 == 1) // Opening delimiter
+					// Check to see if it matches a closing delimiter
+					if( this->stack.size() > 0 && this->stack.back() == i && this->sym[i] )
 					{
-						// Check to see if it matches a closing delimiter
-						if( this->stack.size() > 0 && this->stack.back() == i && this->comp( &(this->source[this->pos]), &(this->pairs[i + 1]) ) == 0 )
-						{
-							// Handle it like a closing delimiter if it is already on the stack AND it is at the top of the stack
-							this->pop();
-						}
-						else
-						{
-							// Otherwise, handle it like an opening delimiter
-							this->push(i);
-						}
+						// Handle it like a closing delimiter if it is already on the stack AND it is at the top of the stack
+						this->pop();
+					}
+					else if( this->stack.size() >= this->maxDepth )
+					{
+						// Nesting past the maximum depth
+						this->err = this->tooDeepErr(this->text(i));
+						return false;
 					}
-					else           // Closing delimiter
+					else
+					{
+						// Otherwise, handle it like an opening delimiter
+						this->push(i);
+					}
+				}
+				else           // Closing delimiter
+				{
+					// Pop only if valid closing delimiter
+					if( this->stack.size() > 0 )
 					{
-						// Pop only if valid closing delimiter
-						if( this->stack.size() > 0 )
+						if(this->stack.back() == i - 1)
 						{
-							if(this->stack.back() == i - 1)
-							{
-								// Safe to pop()
-								this->pop();
-							}
-							else
-							{
-								// This closing delimiter does not match the one found on top of the stack
-								this->err = this->mismatchErr(this->pairs[this->stack.back()], this->pairs[i]);
-								return out;
-							}
+							// Safe to pop()
+							this->pop();
 						}
 						else
 						{
-							// No opening delimiters found on the stack
-							this->err = this->noStartErr(this->pairs[i]);
-							return out;
+							// This closing delimiter does not match the one found on top of the stack
+							this->err = this->mismatchErr(this->text(this->stack.back()), this->text(i));
+							return false;
 						}
-						
-						// Save last index to be popped
-						this->odelim = i - 1;
 					}
-					
-					// Attempt to generate a token
-					out = this->getPortion(true);
-					
-					// Clean up and end
-					this->pos += 1;
-					if(this->pos >= this->source.size() && this->stack.size() > 0)
+					else
 					{
-						// Unclosed delimiter error
-						this->err = this->noCloseErr();
+						// No opening delimiters found on the stack
+						this->err = this->noStartErr(this->text(i));
+						return false;
 					}
-					return out;
+					
+					// Save last index to be popped
+					this->odelim = i - 1;
 				}
+				
+				// Mark the token and move start past the delimiter
+				from = this->start;
+				len = this->pos - this->start;
+				this->start = this->pos + w;
+				
+				// Clean up and end
+				this->pos += w;
+				if(this->pos >= this->src().size() && this->stack.size() > 0)
+				{
+					// Unclosed delimiter error
+					this->err = this->noCloseErr();
+				}
+				return true;
 			}
 			
 			// Clean up and end
 			this->pos += 1;
-			if(this->pos >= this->source.size() && this->stack.size() > 0)
+			if(this->pos >= this->src().size() && this->stack.size() > 0)
 			{
 				// Unclosed delimiter error
 				this->err = this->noCloseErr();
 			}
-			return out;
+			return false;
+		};
+		
+		// Get the offset of the first element of s[0, len) that may start the escape or a delimiter, or len if there is none
+		size_t find(const T* s, size_t len)
+		{
+			// Vectorised for integers of 1, 2 or 4 bytes, as the string PDAs do
+			if constexpr(raw && std::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4))
+			{
+				if(this->needles.size() <= PDA_SIMD_MAX)
+					return pdaFindAny(s, len, this->needles.data(), (unsigned int)this->needles.size());
+			}
+			
+			for(size_t n = 0; n < len; n++)
+			{
+				for(size_t k = 0; k < this->needles.size(); k++)
+				{
+					if( this->comp( s[n], this->needles[k] ) )
+						return n;
+				}
+			}
+			
+			return len;
+		};
+		
+		// Skip to the next escape or delimiter element, then step over it
+		bool stepDelim(size_t& from, size_t& len)
+		{
+			// An escaped element is consumed like any other
+			if(this->esc)
+				this->step(from, len);
+			
+			this->skip();
+			return this->step(from, len);
+		};
+		
+		/* Initialization */
+		
+		// Set up everything but the source, shared by the constructors
+		void init(std::vector<T> p, bool n, Compare co, Copy cp, ToString ts)
+		{
+			// Load info
+			this->pairs = std::move(p);
+			this->noisy = n;
+			
+			// An opening delimiter that is also its closing delimiter closes its own block
+			this->sym.assign(this->pairs.size(), false);
+			for(unsigned int i = 1; i + 1 < this->pairs.size(); i += 2)
+			{
+				if(this->seqs.empty())
+				{
+					this->sym[i] = co( this->pairs[i], this->pairs[i + 1] );
+				}
+				else if(this->seqs[i].size() == this->seqs[i + 1].size())
+				{
+					this->sym[i] = true;
+					for(size_t k = 0; k < this->seqs[i].size(); k++)
+					{
+						if( !co( this->seqs[i][k], this->seqs[i + 1][k] ) )
+							this->sym[i] = false;
+					}
+				}
+			}
+			
+			// Elements skip() stops at, an empty delimiter having none
+			this->needles.clear();
+			for(size_t i = 0; i < this->pairs.size(); i++)
+			{
+				if(!this->seqs.empty() && this->seqs[i].empty())
+					continue;
+				
+				bool seen = false;
+				for(size_t k = 0; k < this->needles.size(); k++)
+				{
+					if( co( this->needles[k], this->pairs[i] ) )
+						seen = true;
+				}
+				
+				if(!seen)
+					this->needles.push_back(this->pairs[i]);
+			}
+			
+			// Stack... is already initialized to an empty vector
+			this->maxDepth = PDA_MAX_DEPTH;
+			
+			// Tracking
+			this->start = 0;
+			this->pos = 0;
+			this->esc = false;
+			
+			// Comparator, copy and toString policies
+			this->comp = co;
+			this->cpy = cp;
+			this->tstr = ts;
+			
+			// Error codes
+			this->err = 0;
+			
+			// Delimiter index
+			this->odelim = 0;
+		};
+		
+		// Set up from delimiters given as sequences, keeping them whole if one is longer than one element
+		void init(std::vector<std::vector<T> > p, bool n, Compare co, Copy cp, ToString ts)
+		{
+			std::vector<T> first;
+			
+			this->seqs.clear();
+			for(size_t i = 0; i < p.size(); i++)
+			{
+				if(p[i].size() != 1)
+					this->seqs = p;
+			}
+			
+			// An empty delimiter matches nothing, a default element only holds its place in pairs
+			for(size_t i = 0; i < p.size(); i++)
+			{
+				first.push_back(p[i].empty() ? T() : p[i][0]);
+			}
+			
+			this->init(std::move(first), n, co, cp, ts);
+		};
+		
+	public:
+		/* Constructors */
+		
+		// Policy constructors, a PDAFn<T> takes the function pointer constructors below instead
+		
+		// Read a copy of src, or take it over without copying when it is moved in
+		PDA(std::vector<T> src, std::vector<T> p, bool n, Compare co = Compare(), Copy cp = Copy(), ToString ts = ToString())
+		{
+			static_assert(!std::is_same<Compare, PDAFnCompare<T> >::value, "PDAFn<T> needs its function pointers");
+			
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(std::move(p), n, co, cp, ts);
+		};
+		
+		// Read src in place without copying it; the caller must keep it alive while the PDA is in use
+		PDA(PDASpan<T> src, std::vector<T> p, bool n, Compare co = Compare(), Copy cp = Copy(), ToString ts = ToString())
+		{
+			static_assert(!std::is_same<Compare, PDAFnCompare<T> >::value, "PDAFn<T> needs its function pointers");
+			
+			this->ext = src;
+			this->borrowed = true;
+			this->init(std::move(p), n, co, cp, ts);
+		};
+		
+		// Read len elements from src in place without copying them; the caller must keep them alive while the PDA is in use
+		PDA(const T* src, size_t len, std::vector<T> p, bool n, Compare co = Compare(), Copy cp = Copy(), ToString ts = ToString())
+		{
+			static_assert(!std::is_same<Compare, PDAFnCompare<T> >::value, "PDAFn<T> needs its function pointers");
+			
+			this->ext = PDASpan<T>(src, len);
+			this->borrowed = true;
+			this->init(std::move(p), n, co, cp, ts);
+		};
+		
+		// Delimiters any number of elements long, the longest one starting at a position wins
+		
+		PDA(std::vector<T> src, std::vector<std::vector<T> > p, bool n, Compare co = Compare(), Copy cp = Copy(), ToString ts = ToString())
+		{
+			static_assert(!std::is_same<Compare, PDAFnCompare<T> >::value, "PDAFn<T> needs its function pointers");
+			
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(std::move(p), n, co, cp, ts);
+		};
+		
+		PDA(PDASpan<T> src, std::vector<std::vector<T> > p, bool n, Compare co = Compare(), Copy cp = Copy(), ToString ts = ToString())
+		{
+			static_assert(!std::is_same<Compare, PDAFnCompare<T> >::value, "PDAFn<T> needs its function pointers");
+			
+			this->ext = src;
+			this->borrowed = true;
+			this->init(std::move(p), n, co, cp, ts);
+		};
+		
+		PDA(const T* src, size_t len, std::vector<std::vector<T> > p, bool n, Compare co = Compare(), Copy cp = Copy(), ToString ts = ToString())
+		{
+			static_assert(!std::is_same<Compare, PDAFnCompare<T> >::value, "PDAFn<T> needs its function pointers");
+			
+			this->ext = PDASpan<T>(src, len);
+			this->borrowed = true;
+			this->init(std::move(p), n, co, cp, ts);
+		};
+		
+		// Function pointer constructors, only for PDAFn<T>
+		// The copy function's result is freed with the destructor function
+		PDA(std::vector<T> src, std::vector<T> p, comparatorF co, copyF cp, toStringF ts, destructorF de, bool n)
+		{
+			static_assert(std::is_constructible<Compare, comparatorF>::value, "Function pointers need PDAFn<T>");
+			
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(std::move(p), n, Compare(co), Copy(cp, de), ToString(ts));
+		};
+		
+		PDA(PDASpan<T> src, std::vector<T> p, comparatorF co, copyF cp, toStringF ts, destructorF de, bool n)
+		{
+			static_assert(std::is_constructible<Compare, comparatorF>::value, "Function pointers need PDAFn<T>");
+			
+			this->ext = src;
+			this->borrowed = true;
+			this->init(std::move(p), n, Compare(co), Copy(cp, de), ToString(ts));
+		};
+		
+		PDA(const T* src, size_t len, std::vector<T> p, comparatorF co, copyF cp, toStringF ts, destructorF de, bool n)
+		{
+			static_assert(std::is_constructible<Compare, comparatorF>::value, "Function pointers need PDAFn<T>");
+			
+			this->ext = PDASpan<T>(src, len);
+			this->borrowed = true;
+			this->init(std::move(p), n, Compare(co), Copy(cp, de), ToString(ts));
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		/* Traverse automata */
+		
+		// Read next element from source
+		std::vector<T> readNext()
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+				return this->copyPortion(from, len);
+			
+			return std::vector<T>();
+		};
+		
+		// Read next element from source, copying the token over out and reusing its capacity
+		// Returns true if a token was read, out is left empty otherwise
+		bool readNext(std::vector<T>& out)
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+			{
+				this->copyPortion(from, len, out);
+				return true;
+			}
+			
+			out.clear();
+			return false;
+		};
+		
+		// Read next element from source, giving the token as a view into source instead of a copy
+		// The view is only valid for as long as the source is
+		PDASpan<T> readNextView()
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+				return PDASpan<T>(this->src().data() + from, len);
+			
+			return PDASpan<T>();
+		};
+		
+		// Skip ahead over elements that are neither the escape nor a delimiter
+		// Leaves the automata where the same number of readNext() calls would have, and returns the number of elements skipped
+		size_t skip()
+		{
+			// Do not proceed if error code is set, end of source is reached or the next element is escaped
+			if(this->err < 0 || this->pos >= this->src().size() || this->esc)
+				return 0;
+			
+			size_t n = this->find(this->src().data() + this->pos, this->src().size() - this->pos);
+			
+			if(n > 0)
+			{
+				// readNext() would have reset the last opening delimiter popped
+				this->odelim = 0;
+				
+				// Clean up and end
+				this->pos += n;
+				if(this->pos >= this->src().size() && this->stack.size() > 0)
+				{
+					// Unclosed delimiter error
+					this->err = this->noCloseErr();
+				}
+			}
+			
+			return n;
+		};
+		
+		// Read up to and including the next escape or delimiter element
+		// Returns the token that calling readNext() on every element up to that point would have
+		std::vector<T> readNextDelim()
+		{
+			size_t from, len;
+			
+			if(this->stepDelim(from, len))
+				return this->copyPortion(from, len);
+			
+			return std::vector<T>();
+		};
+		
+		// Same as readNextDelim(), giving the token as a view into source instead of a copy
+		PDASpan<T> readNextDelimView()
+		{
+			size_t from, len;
+			
+			if(this->stepDelim(from, len))
+				return PDASpan<T>(this->src().data() + from, len);
+			
+			return PDASpan<T>();
 		};
 		
 		/* Reporting */
 		
 		// Get current position of automata
-		unsigned int getPos()
+		size_t getPos()
 		{
 			return this->pos;
 		};
@@ -271,11 +953,23 @@ class PDA
 		};
 		
 		// Get the depth of the stack
-		unsigned int stackDepth()
+		size_t stackDepth()
 		{
 			return this->stack.size();
 		};
 		
+		// Set the most delimiters the stack may hold; opening one more stops the automata with a too deep error
+		void setMaxDepth(size_t depth)
+		{
+			this->maxDepth = depth;
+		};
+		
+		// Get the most delimiters the stack may hold
+		size_t getMaxDepth()
+		{
+			return this->maxDepth;
+		};
+		
 		// Check if escape character flag is set
 		bool isEsc()
 		{
@@ -288,14 +982,26 @@ class PDA
 		{
 			std::vector<T> out;
 			
-			for(unsigned int i = this->start; i < this->pos; i++)
+			if(this->pos > this->start)
+				out = this->copyPortion(this->start, this->pos - this->start);
+			
+			// Update start if necessary
+			if(update)
 			{
-				// Add to output vector
-				T* temp;
-				temp = (T*)( this->cpy( (void*)&(this->source[i]) ) );
-				out.push_back(*temp);
+				this->start = this->pos + 1;
 			}
 			
+			return out;
+		};
+		
+		// Same as getPortion(), giving the portion as a view into source instead of a copy
+		PDASpan<T> getPortionView(bool update)
+		{
+			PDASpan<T> out;
+			
+			if(this->pos > this->start)
+				out = PDASpan<T>(this->src().data() + this->start, this->pos - this->start);
+			
 			// Update start if necessary
 			if(update)
 			{
@@ -305,10 +1011,23 @@ class PDA
 			return out;
 		};
 		
+		// Print a delimiter, element by element
+		std::string delimString(PDASpan<T> d)
+		{
+			std::string out;
+			
+			for(size_t i = 0; i < d.size(); i++)
+			{
+				out += this->tstr(d[i]);
+			}
+			
+			return out;
+		};
+		
 		// Report starting delimiter missing
-		int noStartErr(T close)
+		int noStartErr(PDASpan<T> close)
 		{
-			std::cout << "[Error] Non-escaped delimiter " << this->tstr((void*)(&close)) << " has no starting complement\n";
+			std::cout << "[Error] Non-escaped delimiter " << this->delimString(close) << " has no starting complement\n";
 			
 			return -1;
 		};
@@ -317,10 +1036,10 @@ class PDA
 		int noCloseErr()
 		{
 			std::cout << "[Error] Non-escaped delimiter(s) [ ";
-			for(unsigned int i = 0; i < this->stack.size(); i++)
+			for(size_t i = 0; i < this->stack.size(); i++)
 			{
-				int j = this->stack[i];
-				std::cout << this->tstr( (void*)&(this->pairs[j]) ) << " ";
+				unsigned int j = this->stack[i];
+				std::cout << this->delimString(this->text(j)) << " ";
 			}
 			std::cout << "] do(es) not have a closing complement\n";
 			
@@ -328,13 +1047,21 @@ class PDA
 		};
 		
 		// Report starting/closing delimiter pair mismatch
-		int mismatchErr(T start, T close)
+		int mismatchErr(PDASpan<T> open, PDASpan<T> close)
 		{
-			std::cout << "[Error] Starting delimiter " << this->tstr((void*)(&start)) << " does not pair with closing delimiter " << this->tstr((void*)(&close)) << "\n";
+			std::cout << "[Error] Starting delimiter " << this->delimString(open) << " does not pair with closing delimiter " << this->delimString(close) << "\n";
 			
 			return -3;
 		};
 		
+		// Report nesting past the maximum depth
+		int tooDeepErr(PDASpan<T> open)
+		{
+			std::cout << "[Error] Delimiter " << this->delimString(open) << " nests deeper than the maximum depth of " << this->maxDepth << "\n";
+			
+			return -4;
+		};
+		
 		/* Destructor */
 		~PDA()
 		{
@@ -343,4 +1070,9 @@ class PDA
 };
 
 
+// PDA<T> driven by the original comparator/copy/toString/destructor function pointers
+template <typename T>
+using PDAFn = PDA<T, PDAFnCompare<T>, PDAFnCopy<T>, PDAFnToString<T> >;
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,1194 @@
+#ifndef PDA_BASIC_STRING_H
+#define PDA_BASIC_STRING_H
+
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+	#include <fcntl.h>
+	#include <io.h>
+#endif
+
+#include "pda_grammar.h"
+
+/************************************************
+ * Console the string PDAs report to
+ * char prints to std::cout and wchar_t to std::wcout; other character types print to std::cout,
+ * ASCII as it is and every other code unit as \u{...}
+ ************************************************/
+template <typename CharT>
+class PDAConsole
+{
+	public:
+		static std::ostream& out()
+		{
+			return std::cout;
+		};
+		
+		// Get a delimiter in a form out() can print
+		static std::string show(std::basic_string_view<CharT> d)
+		{
+			std::ostringstream text;
+			
+			for(size_t i = 0; i < d.length(); i++)
+			{
+				unsigned long c = (unsigned long)(typename std::make_unsigned<CharT>::type)d[i];
+				
+				if(c < 0x80)
+					text << (char)c;
+				else
+					text << "\\u{" << std::hex << c << std::dec << "}";
+			}
+			
+			return text.str();
+		};
+		
+		// Get the console ready, once per PDA
+		static void setup()
+		{
+			// Nothing to do, really
+		};
+};
+
+template <>
+class PDAConsole<char>
+{
+	public:
+		static std::ostream& out()
+		{
+			return std::cout;
+		};
+		
+		static std::string_view show(std::string_view d)
+		{
+			return d;
+		};
+		
+		static void setup()
+		{
+			// Nothing to do, really
+		};
+};
+
+template <>
+class PDAConsole<wchar_t>
+{
+	public:
+		static std::wostream& out()
+		{
+			return std::wcout;
+		};
+		
+		static std::wstring_view show(std::wstring_view d)
+		{
+			return d;
+		};
+		
+		// Set unicode output
+		static void setup()
+		{
+#if defined(_WIN32)
+			_setmode(_fileno(stdout), _O_U16TEXT);
+#endif
+		};
+};
+
+
+/************************************************
+ * Specialized type basic_string, for any character type and traits
+ * Source is a string of CharT, delimiters are compiled into a PDAGrammar<CharT>
+ * pda_string.h and pda_wstring.h give PDA<std::string> and PDA<std::wstring>;
+ * char8_t, char16_t and char32_t strings work the same way
+ ************************************************/
+template <typename CharT, typename Traits, typename Alloc>
+class PDA<std::basic_string<CharT, Traits, Alloc> >
+{
+	private:
+		typedef std::basic_string<CharT, Traits, Alloc> Source;
+		typedef std::basic_string_view<CharT, Traits> View;
+		typedef std::basic_string_view<CharT> Text;  // Delimiter as the grammar gives it
+		typedef PDAConsole<CharT> Console;
+		
+		Source source;                   // Source to read from when the PDA owns it (generally some kind of list or string)
+		View ext;                        // Source to read from when the caller owns it and keeps it alive
+		bool borrowed;                   // True if reading from ext instead of source
+		size_t base;                     // Position of the first character still held in the source, past 0 only when streaming
+		bool eof;                        // True once the whole source is known, false while a stream can still be fed
+		PDAStack<> stack;                // Stack used to keep track of delimiter pairs, array of indices from delimiter pairs vector
+		size_t maxDepth;                 // Most delimiters the stack may hold, opening one more is an error
+		const PDAGrammar<CharT>* g;      // Compiled delimiter set, read only and possibly shared with other PDAs
+		std::shared_ptr<const PDAGrammar<CharT> > own; // Grammar compiled by this PDA from a pairs vector, empty if borrowed
+		size_t start;                    // Starting position of valid token
+		size_t pos;                      // Current read position of PDA
+		bool esc;                        // True if an escape character was found
+		
+		bool noisy;                      // push() and pop() output to command line when set
+		
+		// Error checking
+		// < 0 means error, do not continue
+		int err;
+		
+		// Index of last opening delimiter popped
+		unsigned int odelim;
+		
+		// Index into pairs of the delimiter read by the last step()
+		unsigned int last;
+		
+		// True if a stream ends partway through what could be a delimiter, so more must be fed before reading on
+		bool wait;
+		
+		// Incremental reading
+		std::vector<PDACheckpoint> checkpoints; // States saved by readAll() and applyEdit(), in source order
+		size_t every;                    // Characters between checkpoints, 0 to save none
+		
+		// Private default constructor
+		PDA() { }
+		
+		/*******************************************
+		 * Private Functions
+		 *******************************************/
+		
+		/* Source */
+		
+		// Get the source being read, whoever owns it
+		View src()
+		{
+			if(this->borrowed)
+				return this->ext;
+			
+			return View(this->source);
+		};
+		
+		// Get the position just past the last character read in so far
+		size_t end()
+		{
+			return this->base + this->src().length();
+		};
+		
+		/* Stack manipulation */
+		
+		// Add index of a delimiter to the stack
+		void push(unsigned int index)
+		{
+			this->stack.push_back(index);
+			
+			if(this->noisy)
+			{
+				Console::out() << "after push at " << this->pos << " [";
+				for(size_t i = 0; i < this->stack.size(); i++)
+				{
+					Console::out() << this->stack[i] << ", ";
+				}
+				Console::out() << "]\n";
+			}
+		};
+		
+		// Remove index of a delimiter from the stack when its complement is found
+		// Resets the saved delimiter index to the last element of the stack
+		void pop()
+		{
+			if(this->stack.size() > 0)
+			{
+				this->odelim = this->stack.back();
+				this->stack.pop_back();
+			}
+			else // Cannot pop from empty stack
+			{
+				Console::out() << "Nothing to pop from stack";
+			}
+			
+			if(this->noisy)
+			{
+				Console::out() << "after pop at " << this->pos << " [";
+				for(size_t i = 0; i < this->stack.size(); i++)
+				{
+					Console::out() << this->stack[i] << ", ";
+				}
+				Console::out() << "]\n";
+			}
+		};
+		
+		/* Transitions */
+		
+		// Get the opening delimiter of the quoted block being read, PDA_PLAIN if delimiters are read as usual
+		unsigned int quote()
+		{
+			if(this->stack.size() > 0 && this->g->quoted(this->stack.back()))
+				return this->stack.back();
+			
+			return PDA_PLAIN;
+		};
+		
+		// Read next element from source and move the automata along
+		// Returns true if a delimiter closed a token, which is then source[from, from + len)
+		bool step(size_t& from, size_t& len)
+		{
+			// Do not proceed if error code is set or end of source is reached
+			if(this->err < 0 || this->pos >= this->end())
+				return false;
+			
+			// Reset the last opening delimiter popped, assuming that the user has already accessed it
+			if(this->odelim != 0)
+				this->odelim = 0;
+			
+			// There's nothing to do if this character is escaped
+			if(this->esc == true)
+			{
+				this->esc = false;
+				
+				// Clean up and end
+				this->pos += 1;
+				if(this->pos >= this->end() && this->eof && this->stack.size() > 0)
+				{
+					// Unclosed delimiter error
+					this->err = this->noCloseErr();
+				}
+				return false;
+			}
+			
+			// Find the longest escape or delimiter starting here, through the grammar's class table
+			// Inside a quoted block only its closing delimiter and the escape count
+			unsigned int i;
+			bool cut;
+			unsigned int q = this->quote();
+			const CharT* s = this->src().data() + (this->pos - this->base);
+			size_t w = (q == PDA_PLAIN) ? this->g->match(s, this->end() - this->pos, i, cut) : this->g->matchIn(q, s, this->end() - this->pos, i, cut);
+			
+			// A delimiter may go on in the next chunk of a stream
+			if(cut && !this->eof)
+			{
+				this->wait = true;
+				return false;
+			}
+			
+			// There's nothing to do if this is an escape character
+			if(i == 0)
+			{
+				this->esc = true;
+				
+				// Clean up and end
+				this->pos += w;
+				if(this->pos >= this->end() && this->eof && this->stack.size() > 0)
+				{
+					// Unclosed delimiter error
+					this->err = this->noCloseErr();
+				}
+				return false;
+			}
+			
+			// Check for delimiters
+			if(i != PDA_PLAIN)
+			{
+				// What kind of delimiter is this?
+				if(i % 2 == 1) // Opening delimiter
+				{
+					// Check to see if it matches a closing delimiter
+					if( this->stack.size() > 0 && this->stack.back() == i && this->g->symmetric(i) )
+					{
+						// Handle it like a closing delimiter if it is already on the stack AND it is at the top of the stack
+						this->pop();
+					}
+					else if( this->stack.size() >= this->maxDepth )
+					{
+						// Nesting past the maximum depth
+						this->err = this->tooDeepErr(this->g->text(i));
+						return false;
+					}
+					else
+					{
+						// Otherwise, handle it like an opening delimiter
+						this->push(i);
+					}
+				}
+				else           // Closing delimiter
+				{
+					// Pop only if valid closing delimiter
+					if( this->stack.size() > 0 )
+					{
+						if(this->stack.back() == i - 1)
+						{
+							// Safe to pop()
+							this->pop();
+						}
+						else
+						{
+							// This closing delimiter does not match the one found on top of the stack
+							this->err = this->mismatchErr(this->g->text(this->stack.back()), this->g->text(i));
+							return false;
+						}
+					}
+					else
+					{
+						// No opening delimiters found on the stack
+						this->err = this->noStartErr(this->g->text(i));
+						return false;
+					}
+					
+					// Save last index to be popped
+					this->odelim = i - 1;
+				}
+				
+				// Mark the token and move start past the delimiter
+				from = this->start;
+				len = this->pos - this->start;
+				this->start = this->pos + w;
+				this->last = i;
+				
+				// Clean up and end
+				this->pos += w;
+				if(this->pos >= this->end() && this->eof && this->stack.size() > 0)
+				{
+					// Unclosed delimiter error
+					this->err = this->noCloseErr();
+				}
+				return true;
+			}
+			
+			// Clean up and end
+			this->pos += 1;
+			if(this->pos >= this->end() && this->eof && this->stack.size() > 0)
+			{
+				// Unclosed delimiter error
+				this->err = this->noCloseErr();
+			}
+			return false;
+		};
+		
+		// Skip ahead over characters that are neither the escape nor a delimiter, stopping at limit at the latest
+		size_t skipTo(size_t limit)
+		{
+			// Do not proceed if error code is set, end of source is reached or the next character is escaped
+			if(this->err < 0 || this->pos >= limit || this->pos >= this->end() || this->esc)
+				return 0;
+			
+			const CharT* s = this->src().data() + (this->pos - this->base);
+			size_t len = std::min(limit, this->end()) - this->pos;
+			unsigned int q = this->quote();
+			size_t n = (q == PDA_PLAIN) ? this->g->find(s, len) : this->g->findIn(q, s, len);
+			
+			if(n > 0)
+			{
+				// readNext() would have reset the last opening delimiter popped
+				this->odelim = 0;
+				
+				// Clean up and end
+				this->pos += n;
+				if(this->pos >= this->end() && this->eof && this->stack.size() > 0)
+				{
+					// Unclosed delimiter error
+					this->err = this->noCloseErr();
+				}
+			}
+			
+			return n;
+		};
+		
+		// Skip to the next escape or delimiter character, then step over it
+		bool stepDelim(size_t& from, size_t& len)
+		{
+			// An escaped character is consumed like any other
+			if(this->esc)
+				this->step(from, len);
+			
+			this->skip();
+			return this->step(from, len);
+		};
+		
+		/* Checkpoints */
+		
+		// Save the state of the automata
+		void save(PDACheckpoint& c)
+		{
+			c.pos = (pdaOffset)this->pos;
+			c.start = (pdaOffset)this->start;
+			c.esc = this->esc;
+			c.stack.resize(this->stack.size());
+			for(size_t i = 0; i < this->stack.size(); i++)
+			{
+				c.stack[i] = this->stack[i];
+			}
+		};
+		
+		// Go back to a saved state
+		void load(const PDACheckpoint& c)
+		{
+			this->pos = c.pos;
+			this->start = c.start;
+			this->esc = c.esc;
+			this->stack.clear();
+			for(size_t i = 0; i < c.stack.size(); i++)
+			{
+				this->stack.push_back(c.stack[i]);
+			}
+			this->err = 0;
+			this->odelim = 0;
+		};
+		
+		// Check if the automata is in a saved state, reading on from which gives the same result
+		bool same(const PDACheckpoint& c)
+		{
+			if(this->pos != c.pos || this->start != c.start || this->esc != c.esc || this->stack.size() != c.stack.size())
+				return false;
+			
+			for(size_t i = this->stack.size(); i > 0; i--)
+			{
+				if(this->stack[i - 1] != c.stack[i - 1])
+					return false;
+			}
+			
+			return true;
+		};
+		
+		// Read on to the end of the source, saving a checkpoint at every multiple of every
+		// old holds checkpoints of the previous read past an edit, moved to where they are now; once the automata
+		// is in the same state at one of them, it jumps to fin, which the previous read ended in with error code finErr
+		void readOn(std::vector<PDACheckpoint>& old, const PDACheckpoint& fin, int finErr, unsigned int finDelim)
+		{
+			size_t from, len;
+			size_t next = 0;             // First of old not passed yet
+			
+			while(this->err >= 0 && this->pos < this->end() && !this->wait)
+			{
+				// A delimiter longer than one character can step past a checkpoint
+				while(next < old.size() && old[next].pos < this->pos)
+				{
+					next++;
+				}
+				
+				size_t stop = this->end();
+				if(this->every > 0)
+					stop = std::min(stop, (this->pos / this->every + 1) * this->every);
+				if(next < old.size())
+					stop = std::min(stop, (size_t)old[next].pos);
+				
+				this->skipTo(stop);
+				if(this->err < 0 || this->pos >= this->end())
+					break;
+				
+				if(this->pos == stop)
+				{
+					if(next < old.size() && this->pos == old[next].pos)
+					{
+						if(this->same(old[next]))
+						{
+							// Everything from here on is read as before
+							this->checkpoints.insert(this->checkpoints.end(), old.begin() + next, old.end());
+							this->load(fin);
+							this->err = finErr;
+							this->odelim = finDelim;
+							return;
+						}
+						
+						next++;
+					}
+					
+					if(this->every > 0 && this->pos % this->every == 0)
+					{
+						this->checkpoints.push_back(PDACheckpoint());
+						this->save(this->checkpoints.back());
+					}
+				}
+				
+				this->step(from, len);
+			}
+			
+			// Resuming right at the end of the source reads nothing that would report delimiters left open
+			if(this->err >= 0 && this->pos >= this->end() && this->eof && this->stack.size() > 0)
+			{
+				// Unclosed delimiter error
+				this->err = this->noCloseErr();
+			}
+		};
+		
+		// Read the source again after source[offset, offset + removed) was replaced with inserted characters
+		// done is true if the automata had stopped before the edit, at an error or at the end of the source
+		void reread(size_t offset, size_t removed, size_t inserted, bool done)
+		{
+			// An error before the edit is still there, unless the delimiter it stopped at runs into the edit
+			if(this->err < 0 && this->pos + (this->g->longest() - 1) < offset)
+				return;
+			
+			// Where the previous read ended, moved to where it is now
+			PDACheckpoint fin;
+			int finErr = this->err;
+			unsigned int finDelim = this->odelim;
+			this->save(fin);
+			fin.pos = this->moved(fin.pos, offset, removed, inserted, true);
+			fin.start = this->moved(fin.start, offset, removed, inserted, false);
+			
+			// Checkpoints past the edit are kept to compare with, the ones in it are dropped
+			// A checkpoint before the edit is only kept if no delimiter read up to it could have run into the edit
+			std::vector<PDACheckpoint> old;
+			size_t keep = 0;
+			for(size_t i = 0; i < this->checkpoints.size(); i++)
+			{
+				PDACheckpoint& c = this->checkpoints[i];
+				
+				if(c.pos + (this->g->longest() - 1) <= offset)
+				{
+					keep = i + 1;
+				}
+				else if(done && c.pos >= offset + removed && fin.pos != (pdaOffset)-1)
+				{
+					c.pos = this->moved(c.pos, offset, removed, inserted, true);
+					c.start = this->moved(c.start, offset, removed, inserted, false);
+					old.push_back(std::move(c));
+				}
+			}
+			this->checkpoints.resize(keep);
+			
+			// Resume from the last checkpoint before the edit
+			if(keep > 0)
+			{
+				this->load(this->checkpoints.back());
+			}
+			else
+			{
+				this->stack.clear();
+				this->start = 0;
+				this->pos = 0;
+				this->esc = false;
+				this->err = 0;
+				this->odelim = 0;
+			}
+			
+			this->readOn(old, fin, finErr, finDelim);
+		};
+		
+		// Get where position p is after source[offset, offset + removed) was replaced with inserted characters
+		// Positions in the removed characters are gone, (pdaOffset)-1 is given for them
+		// A read position at offset is past the inserted characters (read is true), a token start there is before them
+		static pdaOffset moved(pdaOffset p, size_t offset, size_t removed, size_t inserted, bool read)
+		{
+			if(p < offset || (p == offset && !read))
+				return p;
+			if(p < offset + removed)
+				return (pdaOffset)-1;
+			
+			return (pdaOffset)(p - removed + inserted);
+		};
+		
+		/* Initialization */
+		
+		// Set up everything but the source, shared by the constructors
+		void init(const PDAGrammar<CharT>& gr, bool n)
+		{
+			// Load info
+			this->g = &gr;
+			this->noisy = n;
+			
+			// Stack... is already initialized to an empty vector
+			this->maxDepth = PDA_MAX_DEPTH;
+			
+			// Tracking
+			this->every = 0;
+			this->base = 0;
+			this->eof = true;
+			this->start = 0;
+			this->pos = 0;
+			this->esc = false;
+			
+			// No user-inputted comparator, copy, toString, and destructor functions needed
+			
+			// Error codes
+			this->err = 0;
+			
+			// Delimiter index
+			this->odelim = 0;
+			this->last = 0;
+			this->wait = false;
+			
+			// Set up the console for this character type
+			Console::setup();
+		};
+		
+		// Go back to the state of a freshly constructed PDA, keeping the grammar and the stack's capacity
+		void rewind()
+		{
+			this->stack.clear();
+			this->checkpoints.clear();
+			
+			// Tracking
+			this->base = 0;
+			this->eof = true;
+			this->start = 0;
+			this->pos = 0;
+			this->esc = false;
+			
+			// Error codes
+			this->err = 0;
+			
+			// Delimiter index
+			this->odelim = 0;
+			this->last = 0;
+			this->wait = false;
+		};
+		
+		// Compile a grammar of its own from pairs, then set up as above
+		void init(std::vector<CharT> p, std::vector<unsigned int> q, bool n)
+		{
+			this->own = std::make_shared<const PDAGrammar<CharT> >(std::move(p), std::move(q));
+			this->init(*this->own, n);
+		};
+		
+		void init(std::vector<std::basic_string<CharT> > p, std::vector<unsigned int> q, bool n)
+		{
+			this->own = std::make_shared<const PDAGrammar<CharT> >(std::move(p), std::move(q));
+			this->init(*this->own, n);
+		};
+		
+		// A temporary grammar would be gone before the first read, so these are left undefined
+		PDA(Source src, const PDAGrammar<CharT>&& gr, bool n);
+		PDA(const CharT* src, const PDAGrammar<CharT>&& gr, bool n);
+		PDA(View src, const PDAGrammar<CharT>&& gr, bool n);
+		PDA(const CharT* src, size_t len, const PDAGrammar<CharT>&& gr, bool n);
+		PDA(const PDAGrammar<CharT>&& gr, bool n);
+		
+	public:
+		/* Constructors */
+		
+		// Each delimiter in p is one character, q holds the indices of the opening delimiters of quoted pairs as for PDAGrammar
+		
+		// Read a copy of src, or take it over without copying when it is moved in
+		PDA(Source src, std::vector<CharT> p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		// Read a copy of a null-terminated string
+		PDA(const CharT* src, std::vector<CharT> p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->source = src;
+			this->borrowed = false;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		// Read src in place without copying it; the caller must keep it alive while the PDA is in use
+		PDA(View src, std::vector<CharT> p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->ext = src;
+			this->borrowed = true;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		// Read len characters from src in place without copying them; the caller must keep them alive while the PDA is in use
+		PDA(const CharT* src, size_t len, std::vector<CharT> p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->ext = View(src, len);
+			this->borrowed = true;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		// Read a source that arrives in chunks through feed(), ending with finish()
+		PDA(std::vector<CharT> p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->borrowed = false;
+			this->init(std::move(p), std::move(q), n);
+			this->eof = false;
+		};
+		
+		// Each delimiter in p is any number of characters, e.g. {"\\", "/*", "*/", "{{", "}}"}
+		
+		PDA(Source src, std::vector<std::basic_string<CharT> > p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		PDA(const CharT* src, std::vector<std::basic_string<CharT> > p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->source = src;
+			this->borrowed = false;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		PDA(View src, std::vector<std::basic_string<CharT> > p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->ext = src;
+			this->borrowed = true;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		PDA(const CharT* src, size_t len, std::vector<std::basic_string<CharT> > p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->ext = View(src, len);
+			this->borrowed = true;
+			this->init(std::move(p), std::move(q), n);
+		};
+		
+		PDA(std::vector<std::basic_string<CharT> > p, bool n, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->borrowed = false;
+			this->init(std::move(p), std::move(q), n);
+			this->eof = false;
+		};
+		
+		// Cursors over a grammar compiled beforehand, so nothing is built per parse
+		// The caller must keep gr alive while the PDA is in use; gr is only ever read, so any number of threads may share it
+		
+		PDA(Source src, const PDAGrammar<CharT>& gr, bool n)
+		{
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(gr, n);
+		};
+		
+		PDA(const CharT* src, const PDAGrammar<CharT>& gr, bool n)
+		{
+			this->source = src;
+			this->borrowed = false;
+			this->init(gr, n);
+		};
+		
+		PDA(View src, const PDAGrammar<CharT>& gr, bool n)
+		{
+			this->ext = src;
+			this->borrowed = true;
+			this->init(gr, n);
+		};
+		
+		PDA(const CharT* src, size_t len, const PDAGrammar<CharT>& gr, bool n)
+		{
+			this->ext = View(src, len);
+			this->borrowed = true;
+			this->init(gr, n);
+		};
+		
+		PDA(const PDAGrammar<CharT>& gr, bool n)
+		{
+			this->borrowed = false;
+			this->init(gr, n);
+			this->eof = false;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		/* Traverse automata */
+		
+		// Read next element from source
+		Source readNext()
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+				return Source(this->src().substr(from - this->base, len));
+			
+			return Source();
+		};
+		
+		// Read next element from source, giving the token as a view into source instead of a copy
+		// The view is only valid for as long as the source is
+		View readNextView()
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+				return this->src().substr(from - this->base, len);
+			
+			return View();
+		};
+		
+		// Skip ahead over characters that are neither the escape nor a delimiter
+		// Leaves the automata where the same number of readNext() calls would have, and returns the number of characters skipped
+		size_t skip()
+		{
+			return this->skipTo(this->end());
+		};
+		
+		// Read up to and including the next escape or delimiter character
+		// Returns the token that calling readNext() on every character up to that point would have
+		Source readNextDelim()
+		{
+			size_t from, len;
+			
+			if(this->stepDelim(from, len))
+				return Source(this->src().substr(from - this->base, len));
+			
+			return Source();
+		};
+		
+		// Same as readNextDelim(), giving the token as a view into source instead of a copy
+		View readNextDelimView()
+		{
+			size_t from, len;
+			
+			if(this->stepDelim(from, len))
+				return this->src().substr(from - this->base, len);
+			
+			return View();
+		};
+		
+		/* Bulk tokenizing */
+		
+		// Read the rest of the source in one pass, adding a row to out for every token readNext() would have given
+		// Rows are appended, so clear() out first unless it should keep the rows of earlier calls
+		// Stops where readNext() would; returns the number of rows added, check getErr() afterwards
+		size_t tokenizeAll(PDATokenTable& out)
+		{
+			size_t rows = out.size();
+			size_t from, len;
+			
+			while(this->err >= 0 && this->pos < this->end() && !this->wait)
+			{
+				size_t depth = this->stack.size();
+				
+				if(this->stepDelim(from, len))
+				{
+					out.push_back(from, len, this->last, this->stack.size(), this->stack.size() > depth);
+				}
+			}
+			
+			return out.size() - rows;
+		};
+		
+		/* Events */
+		
+		// Read the rest of the source in one pass, calling h for every event instead of being polled after each readNext()
+		// Handler is usually derived from PDAHandler; its calls are resolved at compile time
+		// Stops where readNext() would, calling h.onError() if it stopped on an error; returns the error code
+		template <typename Handler>
+		int parse(Handler& h)
+		{
+			size_t from, len;
+			
+			while(this->err >= 0 && this->pos < this->end() && !this->wait)
+			{
+				this->skip();
+				if(this->err < 0 || this->pos >= this->end())
+					break;
+				
+				size_t at = this->pos;
+				size_t depth = this->stack.size();
+				bool escaped = this->esc;
+				
+				if(this->step(from, len))
+				{
+					h.onToken(this->src().substr(from - this->base, len));
+					
+					if(this->stack.size() > depth)
+						h.onOpen(this->last, at);
+					else
+						h.onClose(this->last, at);
+				}
+				else if(this->esc && !escaped)
+				{
+					h.onEscape(at);
+				}
+			}
+			
+			if(this->err < 0)
+				h.onError(this->err, this->pos);
+			
+			return this->err;
+		}
+		
+		/* Incremental reading */
+		
+		// Save a checkpoint every so many characters while reading with readAll() or applyEdit(), 0 to save none
+		void setCheckpoints(size_t n)
+		{
+			this->every = n;
+		};
+		
+		// Read on to the end of the source, or until an error, saving checkpoints on the way
+		// Returns the error code
+		int readAll()
+		{
+			std::vector<PDACheckpoint> old;
+			PDACheckpoint fin;
+			
+			this->readOn(old, fin, 0, 0);
+			return this->err;
+		};
+		
+		// Replace source[offset, offset + removed) with text, then bring the automata to where readAll() would on the new source
+		// Reading resumes from the last checkpoint before offset, and stops early once the automata is back in the state
+		// the previous read was in at a checkpoint past the edit; returns the error code
+		int applyEdit(size_t offset, size_t removed, View text)
+		{
+			if(!this->eof || this->base != 0)
+			{
+				Console::out() << "[Error] Cannot edit a streamed source\n";
+				return this->err;
+			}
+			
+			bool done = this->err < 0 || this->pos >= this->end();
+			
+			if(this->borrowed)
+			{
+				this->source.assign(this->ext.data(), this->ext.length());
+				this->borrowed = false;
+			}
+			this->source.replace(offset, removed, text.data(), text.length());
+			
+			this->reread(offset, removed, text.length(), done);
+			return this->err;
+		};
+		
+		// Same as applyEdit(), for a borrowed source the caller has already edited; src is the source after the edit
+		int applyEdit(View src, size_t offset, size_t removed, size_t inserted)
+		{
+			if(!this->eof || this->base != 0)
+			{
+				Console::out() << "[Error] Cannot edit a streamed source\n";
+				return this->err;
+			}
+			
+			bool done = this->err < 0 || this->pos >= this->end();
+			
+			this->source.clear();
+			this->ext = src;
+			this->borrowed = true;
+			
+			this->reread(offset, removed, inserted, done);
+			return this->err;
+		};
+		
+		/* Streaming */
+		
+		// Append the next chunk of a streamed source
+		// Characters before the unfinished token are dropped, so only that token is kept between chunks
+		// Views handed out earlier are invalidated
+		void feed(View chunk)
+		{
+			if(this->eof)
+			{
+				Console::out() << "[Error] Cannot feed a source that is not streamed or has been finished\n";
+				return;
+			}
+			
+			// Keep the unfinished token, and whatever has not been read yet
+			size_t keep = (this->start < this->pos) ? this->start : this->pos;
+			this->source.erase(0, keep - this->base);
+			this->base = keep;
+			
+			this->source.append(chunk.data(), chunk.size());
+			this->wait = false;
+		};
+		
+		// Mark the end of a streamed source
+		// Delimiters still open once everything fed has been read are reported as unclosed
+		void finish()
+		{
+			this->eof = true;
+			this->wait = false;
+			
+			if(this->err >= 0 && this->pos >= this->end() && this->stack.size() > 0)
+			{
+				// Unclosed delimiter error
+				this->err = this->noCloseErr();
+			}
+		};
+		
+		// Check if a streamed source has been read up to the end of what was fed
+		bool needsInput()
+		{
+			return !this->eof && this->err >= 0 && (this->pos >= this->end() || this->wait);
+		};
+		
+		/* Reuse */
+		
+		// Start over on a new source with the same grammar, as if the PDA had just been constructed
+		// Nothing is allocated when src is borrowed, or when a copied src fits in the capacity already held
+		
+		void reset(const Source& src)
+		{
+			this->source.assign(src);
+			this->borrowed = false;
+			this->rewind();
+		};
+		
+		// Take over a moved in src, dropping the buffer held so far
+		void reset(Source&& src)
+		{
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->rewind();
+		};
+		
+		void reset(const CharT* src)
+		{
+			this->source.assign(src);
+			this->borrowed = false;
+			this->rewind();
+		};
+		
+		void reset(View src)
+		{
+			this->source.clear();
+			this->ext = src;
+			this->borrowed = true;
+			this->rewind();
+		};
+		
+		void reset(const CharT* src, size_t len)
+		{
+			this->reset(View(src, len));
+		};
+		
+		// Start over on a new streamed source, fed through feed() and ended with finish()
+		void reset()
+		{
+			this->source.clear();
+			this->borrowed = false;
+			this->rewind();
+			this->eof = false;
+		};
+		
+		/* Reporting */
+		
+		// Get current position of automata
+		size_t getPos()
+		{
+			return this->pos;
+		};
+		
+		// Get error code
+		int getErr()
+		{
+			return this->err;
+		};
+		
+		// Get the index of the last delimiter to be pushed onto the stack
+		// 0 if the stack is empty
+		unsigned int lastDelim()
+		{
+			if(this->stack.size() > 0)
+				return this->stack.back();
+			else
+				return 0;
+		};
+		
+		// Get the index of the last delimiter to be removed from the stack
+		unsigned int lastRemoved()
+		{
+			return this->odelim;
+		};
+		
+		// Get the compiled delimiter set, to start more PDAs over the same grammar
+		// It lives as long as this PDA, or as long as the caller's grammar if one was given
+		const PDAGrammar<CharT>& getGrammar()
+		{
+			return *this->g;
+		};
+		
+		// Get the depth of the stack
+		size_t stackDepth()
+		{
+			return this->stack.size();
+		};
+		
+		// Set the most delimiters the stack may hold; opening one more stops the automata with a too deep error
+		void setMaxDepth(size_t depth)
+		{
+			this->maxDepth = depth;
+		};
+		
+		// Get the most delimiters the stack may hold
+		size_t getMaxDepth()
+		{
+			return this->maxDepth;
+		};
+		
+		// Check if escape character flag is set
+		bool isEsc()
+		{
+			return this->esc;
+		};
+		
+		// Get a portion of source from this->start to this->pos as a vector (non-empty if this->start > this->pos)
+		// Update start if update == true
+		Source getPortion(bool update)
+		{
+			Source out = Source(this->src().substr(this->start - this->base, this->pos - this->start));
+			
+			// Update start if necessary
+			if(update)
+			{
+				this->start = this->pos + 1;
+			}
+			
+			return out;
+		};
+		
+		// Same as getPortion(), giving the portion as a view into source instead of a copy
+		View getPortionView(bool update)
+		{
+			View out = this->src().substr(this->start - this->base, this->pos - this->start);
+			
+			// Update start if necessary
+			if(update)
+			{
+				this->start = this->pos + 1;
+			}
+			
+			return out;
+		};
+		
+		// Report starting delimiter missing
+		int noStartErr(Text close)
+		{
+			Console::out() << "[Error] Non-escaped delimiter " << Console::show(close) << " has no starting complement\n";
+			
+			return -1;
+		};
+		
+		// Report closing delimiter missing
+		int noCloseErr()
+		{
+			Console::out() << "[Error] Non-escaped delimiter(s) [ ";
+			for(size_t i = 0; i < this->stack.size(); i++)
+			{
+				unsigned int j = this->stack[i];
+				Console::out() << Console::show(this->g->text(j)) << " ";
+			}
+			Console::out() << "] do(es) not have a closing complement\n";
+			
+			return -2;
+		};
+		
+		// Report starting/closing delimiter pair mismatch
+		int mismatchErr(Text open, Text close)
+		{
+			Console::out() << "[Error] Starting delimiter " << Console::show(open) << " does not pair with closing delimiter " << Console::show(close) << "\n";
+			
+			return -3;
+		};
+		
+		// Report nesting past the maximum depth
+		int tooDeepErr(Text open)
+		{
+			Console::out() << "[Error] Delimiter " << Console::show(open) << " nests deeper than the maximum depth of " << this->maxDepth << "\n";
+			
+			return -4;
+		};
+		
+		/* Destructor */
+		~PDA()
+		{
+			// Nothing to do, really
+		};
+};
+
+
+/************************************************
+ * Specialized type basic_string_view
+ * Same as the basic_string PDA above, for code that names its sources by their view type
+ ************************************************/
+template <typename CharT, typename Traits>
+class PDA<std::basic_string_view<CharT, Traits> > : public PDA<std::basic_string<CharT, Traits> >
+{
+	public:
+		using PDA<std::basic_string<CharT, Traits> >::PDA;
+};
+
+
+#endif
@@ -0,0 +1,430 @@
+#ifndef PDA_GRAMMAR_H
+#define PDA_GRAMMAR_H
+
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "pda_simd.h"
+
+/************************************************
+ * Compiled delimiter set for string PDAs
+ * Built once from a pairs vector and never changed afterwards,
+ * so one grammar can be read by any number of PDAs on any number of threads
+ * Delimiters may be several characters long (e.g. <!-- -->), the longest one starting at a position wins
+ * Quoted pairs (e.g. " ") hold raw text: inside one, only its closing delimiter and the escape are read
+ ************************************************/
+template <typename CharT>
+class PDAGrammar
+{
+	private:
+		// Node of the trie of delimiters
+		class Node
+		{
+			public:
+				unsigned int index;                                  // Index into pairs of the delimiter ending here, PDA_PLAIN if none
+				std::vector<std::pair<CharT, unsigned int> > next;   // Nodes one character further
+		};
+		
+		std::vector<std::basic_string<CharT> > pairs; // Token pairs, store the escape delimiter in index 0
+		std::vector<CharT> first;        // First character of each entry in pairs
+		bool multi;                      // True if a delimiter is longer than one character, so that match() walks the trie
+		size_t width;                    // Length of the longest delimiter
+		std::vector<Node> trie;          // Every delimiter, node 0 being the root, only built if multi
+		std::vector<unsigned int> root;  // Node after the first character, by the class of that character
+		
+		// Class table, index of the first entry in pairs matching each character (PDA_PLAIN if none)
+		// Code units below 256 are looked up directly, wider ones through a page of 256 units that holds a delimiter
+		unsigned int cls[256];
+		std::vector<unsigned int> page;  // Leaf used by each block of 256 code units, 0 if the block holds no delimiter
+		std::vector<unsigned int> leaf;  // 256 entries per leaf, leaf 0 is never used
+		bool far;                        // True if a delimiter lies beyond U+10FFFF and must be searched for in pairs
+		
+		CharT needle[PDA_SIMD_MAX];      // Distinct characters of pairs, searched for by find()
+		unsigned int needles;            // Number of distinct characters in pairs, more than PDA_SIMD_MAX falls back to the class table
+		
+		std::vector<bool> sym;           // True for an opening delimiter that is its own closing delimiter
+		std::vector<bool> quote;         // True for an opening delimiter whose block is quoted
+		bool quotes;                     // True if any pair is quoted
+		
+		// Code unit of a character, without sign extension
+		static unsigned long unit(CharT c)
+		{
+			return (unsigned long)(typename std::make_unsigned<CharT>::type)c;
+		};
+		
+		/*******************************************
+		 * Private Functions
+		 *******************************************/
+		
+		// Build the tables from pairs
+		// Lower indices win, which matches the order pairs used to be searched in
+		void compile()
+		{
+			for(unsigned int i = 0; i < 256; i++)
+			{
+				this->cls[i] = PDA_PLAIN;
+			}
+			
+			this->page.clear();
+			this->leaf.assign(256, PDA_PLAIN);
+			this->far = false;
+			
+			for(unsigned int i = this->first.size(); i > 0; i--)
+			{
+				unsigned long c = unit(this->first[i - 1]);
+				
+				if(c < 256)
+				{
+					this->cls[c] = i - 1;
+					continue;
+				}
+				
+				// Out of range code units are rare enough to fall back to a search
+				if(c > 0x10FFFF)
+				{
+					this->far = true;
+					continue;
+				}
+				
+				if((c >> 8) >= this->page.size())
+				{
+					this->page.resize((c >> 8) + 1, 0);
+				}
+				
+				if(this->page[c >> 8] == 0)
+				{
+					this->page[c >> 8] = this->leaf.size() / 256;
+					this->leaf.resize(this->leaf.size() + 256, PDA_PLAIN);
+				}
+				
+				this->leaf[this->page[c >> 8] * 256 + (c & 0xFF)] = i - 1;
+			}
+			
+			// Collect the distinct characters for the vectorised search
+			this->needles = 0;
+			for(unsigned int i = 0; i < this->first.size(); i++)
+			{
+				if(this->classify(this->first[i]) == i)
+				{
+					if(this->needles < PDA_SIMD_MAX)
+						this->needle[this->needles] = this->first[i];
+					this->needles += 1;
+				}
+			}
+			
+			// An opening delimiter that is also its closing delimiter closes its own block
+			this->sym.assign(this->pairs.size(), false);
+			for(unsigned int i = 1; i + 1 < this->pairs.size(); i += 2)
+			{
+				this->sym[i] = (this->pairs[i] == this->pairs[i + 1]);
+			}
+			
+			// Delimiters longer than one character are matched through a trie
+			this->trie.clear();
+			this->root.clear();
+			if(!this->multi)
+				return;
+			
+			this->trie.push_back(Node());
+			this->trie[0].index = PDA_PLAIN;
+			this->root.assign(this->pairs.size(), 0);
+			
+			for(unsigned int i = 0; i < this->pairs.size(); i++)
+			{
+				unsigned int n = 0;
+				
+				for(size_t k = 0; k < this->pairs[i].length(); k++)
+				{
+					unsigned int m = this->child(n, this->pairs[i][k]);
+					if(m == 0)
+					{
+						m = this->trie.size();
+						this->trie.push_back(Node());
+						this->trie[m].index = PDA_PLAIN;
+						this->trie[n].next.push_back(std::make_pair(this->pairs[i][k], m));
+					}
+					n = m;
+				}
+				
+				// Lower indices win
+				if(this->trie[n].index == PDA_PLAIN)
+					this->trie[n].index = i;
+			}
+			
+			for(unsigned int i = 0; i < this->first.size(); i++)
+			{
+				this->root[i] = this->child(0, this->first[i]);
+			}
+		};
+		
+		// Get the node one character c past node n, 0 if there is none
+		unsigned int child(unsigned int n, CharT c) const
+		{
+			for(size_t k = 0; k < this->trie[n].next.size(); k++)
+			{
+				if(this->trie[n].next[k].first == c)
+					return this->trie[n].next[k].second;
+			}
+			
+			return 0;
+		};
+		
+		// Mark the pairs opened by the delimiters at indices q as quoted
+		// Indices that are not an opening delimiter with a closing delimiter after it are ignored
+		void mark(const std::vector<unsigned int>& q)
+		{
+			this->quote.assign(this->pairs.size(), false);
+			this->quotes = false;
+			
+			for(size_t k = 0; k < q.size(); k++)
+			{
+				if(q[k] % 2 == 1 && q[k] + 1 < this->pairs.size())
+				{
+					this->quote[q[k]] = true;
+					this->quotes = true;
+				}
+			}
+		};
+		
+		// Set up from delimiters given as strings
+		void init(std::vector<std::basic_string<CharT> > p)
+		{
+			this->pairs = std::move(p);
+			this->first.clear();
+			this->multi = false;
+			this->width = 1;
+			
+			for(unsigned int i = 0; i < this->pairs.size(); i++)
+			{
+				this->width = std::max(this->width, this->pairs[i].length());
+				
+				// An empty delimiter would match everywhere, it is kept only to hold its index
+				this->first.push_back(this->pairs[i].empty() ? CharT() : this->pairs[i][0]);
+				if(this->pairs[i].length() != 1)
+					this->multi = true;
+			}
+			
+			this->compile();
+		};
+	
+	public:
+		/* Constructors */
+		
+		// Both are explicit, so a pairs vector is never turned into a temporary grammar that a PDA would point to
+		
+		// One character per delimiter
+		// q holds the indices of the opening delimiters of quoted pairs, e.g. {3} for {'\\', '{', '}', '"', '"'}
+		explicit PDAGrammar(std::vector<CharT> p, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			std::vector<std::basic_string<CharT> > d;
+			
+			d.reserve(p.size());
+			for(size_t i = 0; i < p.size(); i++)
+			{
+				d.push_back(std::basic_string<CharT>(1, p[i]));
+			}
+			
+			this->init(std::move(d));
+			this->mark(q);
+		};
+		
+		// Any number of characters per delimiter, e.g. {"\\", "/*", "*/", "{{", "}}"}
+		explicit PDAGrammar(std::vector<std::basic_string<CharT> > p, std::vector<unsigned int> q = std::vector<unsigned int>())
+		{
+			this->init(std::move(p));
+			this->mark(q);
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Get the index of the first entry in pairs starting with a character (PDA_PLAIN if none)
+		unsigned int classify(CharT ch) const
+		{
+			unsigned long c = unit(ch);
+			
+			if(c < 256)
+				return this->cls[c];
+			
+			if((c >> 8) < this->page.size())
+				return this->leaf[this->page[c >> 8] * 256 + (c & 0xFF)];
+			
+			if(this->far)
+			{
+				for(unsigned int i = 0; i < this->first.size(); i++)
+				{
+					if(this->first[i] == ch)
+						return i;
+				}
+			}
+			
+			return PDA_PLAIN;
+		};
+		
+		// Get the offset of the first escape or delimiter in s[0, len), or len if there is none
+		size_t find(const CharT* s, size_t len) const
+		{
+			if(this->needles <= PDA_SIMD_MAX)
+				return pdaFindAny(s, len, this->needle, this->needles);
+			
+			size_t n = 0;
+			while(n < len && this->classify(s[n]) == PDA_PLAIN)
+			{
+				n++;
+			}
+			
+			return n;
+		};
+		
+		// Get the length of the longest delimiter at the start of s[0, len), 0 if there is none, and its index into pairs
+		// cut is set if a longer delimiter could start there, but s ends before it would
+		size_t match(const CharT* s, size_t len, unsigned int& index, bool& cut) const
+		{
+			unsigned int k = this->classify(s[0]);
+			
+			cut = false;
+			index = k;
+			if(k == PDA_PLAIN)
+				return 0;
+			if(!this->multi)
+				return 1;
+			
+			// Walk the trie, remembering the last delimiter passed
+			unsigned int n = this->root[k];
+			size_t best = 0;
+			index = PDA_PLAIN;
+			
+			for(size_t i = 1; n != 0; i++)
+			{
+				if(this->trie[n].index != PDA_PLAIN)
+				{
+					best = i;
+					index = this->trie[n].index;
+				}
+				
+				if(i >= len)
+				{
+					cut = !this->trie[n].next.empty();
+					break;
+				}
+				
+				n = this->child(n, s[i]);
+			}
+			
+			return best;
+		};
+		
+		// Get the offset of the first escape or closing delimiter in s[0, len) inside the quoted block opened by pairs[open], or len if there is none
+		size_t findIn(unsigned int open, const CharT* s, size_t len) const
+		{
+			CharT set[2];
+			unsigned int n = 0;
+			
+			if(!this->pairs[0].empty())
+				set[n++] = this->first[0];
+			if(!this->pairs[open + 1].empty() && (n == 0 || this->first[open + 1] != set[0]))
+				set[n++] = this->first[open + 1];
+			
+			// Single byte characters are best left to memchr()
+			if(n == 1 && sizeof(CharT) == 1)
+			{
+				const void* at = std::memchr(s, (unsigned char)set[0], len);
+				return (at == NULL) ? len : (const CharT*)at - s;
+			}
+			
+			return pdaFindAny(s, len, set, n);
+		};
+		
+		// Same as match(), inside the quoted block opened by pairs[open]
+		// Only the escape and the closing delimiter are read there, a symmetric one being given as pairs[open] as match() would
+		size_t matchIn(unsigned int open, const CharT* s, size_t len, unsigned int& index, bool& cut) const
+		{
+			unsigned int k[2] = {0, open + 1};
+			size_t best = 0;
+			
+			cut = false;
+			index = PDA_PLAIN;
+			
+			// Lower indices win
+			for(unsigned int j = 0; j < 2; j++)
+			{
+				const std::basic_string<CharT>& d = this->pairs[k[j]];
+				if(d.empty() || d.length() <= best)
+					continue;
+				
+				size_t n = std::min(len, d.length());
+				if(d.compare(0, n, s, n) != 0)
+					continue;
+				
+				if(n < d.length())
+				{
+					cut = true;
+					continue;
+				}
+				
+				best = d.length();
+				index = k[j];
+			}
+			
+			if(index == open + 1 && this->sym[open])
+				index = open;
+			
+			return best;
+		};
+		
+		// Check if the block opened by the delimiter at index i of pairs is quoted
+		bool quoted(unsigned int i) const
+		{
+			return i < this->quote.size() && this->quote[i];
+		};
+		
+		// Check if any pair is quoted
+		bool hasQuotes() const
+		{
+			return this->quotes;
+		};
+		
+		// Check if a delimiter is longer than one character
+		bool isMulti() const
+		{
+			return this->multi;
+		};
+		
+		// Get the length of the longest delimiter, at least 1
+		size_t longest() const
+		{
+			return this->width;
+		};
+		
+		// Get the first character of the delimiter at index i of pairs
+		CharT at(unsigned int i) const
+		{
+			return this->first[i];
+		};
+		
+		// Get the whole delimiter at index i of pairs
+		std::basic_string_view<CharT> text(unsigned int i) const
+		{
+			return this->pairs[i];
+		};
+		
+		// Get the number of entries in pairs
+		unsigned int size() const
+		{
+			return this->pairs.size();
+		};
+		
+		// Check if the opening delimiter at index i is its own closing delimiter
+		bool symmetric(unsigned int i) const
+		{
+			return this->sym[i];
+		};
+};
+
+
+#endif
@@ -0,0 +1,627 @@
+#ifndef PDA_MATCH_H
+#define PDA_MATCH_H
+
+
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <vector>
+
+#include "pda.h"
+
+/************************************************
+ * Bit vector with rank and select
+ * A count of set bits is kept for every 512 bits, so rank counts at most 8 words
+ ************************************************/
+class PDABits
+{
+	private:
+		std::vector<unsigned long long> words;   // 64 bits per word, bit i is bit i % 64 of word i / 64
+		std::vector<pdaOffset> blocks;           // Set bits before every run of 8 words
+		size_t count;                            // Number of bits
+		
+		// Set bits in a word
+		static unsigned int ones(unsigned long long w)
+		{
+			return (unsigned int)std::bitset<64>(w).count();
+		};
+	
+	public:
+		/* Constructor */
+		PDABits()
+		{
+			this->count = 0;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Add a bit at the end
+		void push_back(bool b)
+		{
+			if(this->count % 64 == 0)
+				this->words.push_back(0);
+			
+			if(b)
+				this->words.back() |= 1ULL << (this->count % 64);
+			
+			this->count += 1;
+		};
+		
+		// Set bit i, growing the vector with clear bits up to it
+		void set(size_t i)
+		{
+			if(i >= this->count)
+			{
+				this->count = i + 1;
+				this->words.resize((this->count + 63) / 64, 0);
+			}
+			
+			this->words[i / 64] |= 1ULL << (i % 64);
+		};
+		
+		// Count the set bits once every bit is in, so that rank() and select() can be used
+		void build()
+		{
+			this->blocks.assign(this->words.size() / 8 + 1, 0);
+			
+			pdaOffset r = 0;
+			for(size_t w = 0; w < this->words.size(); w++)
+			{
+				if(w % 8 == 0)
+					this->blocks[w / 8] = r;
+				r += ones(this->words[w]);
+			}
+			
+			if(this->words.size() % 8 == 0)
+				this->blocks[this->words.size() / 8] = r;
+		};
+		
+		// Remove every bit, keeping the capacity for reuse
+		void clear()
+		{
+			this->words.clear();
+			this->blocks.clear();
+			this->count = 0;
+		};
+		
+		// Get bit i, clear past the end
+		bool operator[](size_t i) const
+		{
+			return i < this->count && (this->words[i / 64] >> (i % 64)) & 1;
+		};
+		
+		// Get the number of set bits in [0, i)
+		size_t rank(size_t i) const
+		{
+			if(i > this->count)
+				i = this->count;
+			
+			size_t w = i / 64;
+			size_t r = this->blocks[w / 8];
+			
+			for(size_t k = w / 8 * 8; k < w; k++)
+			{
+				r += ones(this->words[k]);
+			}
+			
+			if(i % 64 != 0)
+				r += ones(this->words[w] & ((1ULL << (i % 64)) - 1));
+			
+			return r;
+		};
+		
+		// Get the position of set bit k, counting from 0 (k must be less than rank(size()))
+		size_t select(size_t k) const
+		{
+			// Last run of words starting with at most k set bits before it
+			size_t lo = 0, hi = this->blocks.size() - 1;
+			while(lo < hi)
+			{
+				size_t mid = (lo + hi + 1) / 2;
+				if(this->blocks[mid] <= k)
+					lo = mid;
+				else
+					hi = mid - 1;
+			}
+			
+			size_t w = lo * 8;
+			k -= this->blocks[lo];
+			
+			while(ones(this->words[w]) <= k)
+			{
+				k -= ones(this->words[w]);
+				w++;
+			}
+			
+			unsigned long long bits = this->words[w];
+			for(; k > 0; k--)
+			{
+				bits &= bits - 1;
+			}
+			
+			return w * 64 + (size_t)std::bitset<64>((bits & (0 - bits)) - 1).count();
+		};
+		
+		// Get the position of clear bit k, counting from 0 (k must be less than size() - rank(size()))
+		size_t select0(size_t k) const
+		{
+			// Last run of words starting with at most k clear bits before it
+			size_t lo = 0, hi = this->blocks.size() - 1;
+			while(lo < hi)
+			{
+				size_t mid = (lo + hi + 1) / 2;
+				if(mid * 512 - this->blocks[mid] <= k)
+					lo = mid;
+				else
+					hi = mid - 1;
+			}
+			
+			size_t w = lo * 8;
+			k -= lo * 512 - this->blocks[lo];
+			
+			while(64 - ones(this->words[w]) <= k)
+			{
+				k -= 64 - ones(this->words[w]);
+				w++;
+			}
+			
+			unsigned long long bits = ~this->words[w];
+			for(; k > 0; k--)
+			{
+				bits &= bits - 1;
+			}
+			
+			return w * 64 + (size_t)std::bitset<64>((bits & (0 - bits)) - 1).count();
+		};
+		
+		// Get the number of bits
+		size_t size() const
+		{
+			return this->count;
+		};
+};
+
+
+/************************************************
+ * Increasing source positions, Elias-Fano coded
+ * For n positions below u, each keeps its lowest log2(u / n) bits as they are
+ * and the rest in unary in a PDABits, so the set takes about 2 + log2(u / n) bits per position
+ ************************************************/
+class PDAPositions
+{
+	private:
+		std::vector<pdaOffset> added;             // Positions added since the last build(), given back by it
+		PDABits high;                             // Bit (p >> shift) + i is set for the position p at index i
+		std::vector<unsigned long long> lows;     // shift lowest bits of every position, packed
+		unsigned int shift;                       // Number of lowest bits kept as they are
+		size_t count;                             // Number of positions
+		size_t top;                               // Largest position >> shift
+		
+		// Get the lowest bits of position i
+		size_t low(size_t i) const
+		{
+			if(this->shift == 0)
+				return 0;
+			
+			size_t b = i * this->shift;
+			unsigned long long v = this->lows[b / 64] >> (b % 64);
+			if(b % 64 + this->shift > 64)
+				v |= this->lows[b / 64 + 1] << (64 - b % 64);
+			
+			return (size_t)(v & ((1ULL << this->shift) - 1));
+		};
+	
+	public:
+		/* Constructor */
+		PDAPositions()
+		{
+			this->shift = 0;
+			this->count = 0;
+			this->top = 0;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Add a position, past every position added before
+		void push_back(size_t p)
+		{
+			this->added.push_back((pdaOffset)p);
+		};
+		
+		// Code the positions added so far, so that they can be looked up
+		void build()
+		{
+			this->count = this->added.size();
+			size_t u = (this->count > 0) ? (size_t)this->added.back() + 1 : 0;
+			
+			this->shift = 0;
+			while(this->count > 0 && ((u / this->count) >> (this->shift + 1)) > 0)
+			{
+				this->shift++;
+			}
+			
+			this->top = (this->count > 0) ? (u - 1) >> this->shift : 0;
+			this->lows.assign((this->count * this->shift + 63) / 64, 0);
+			this->high.clear();
+			
+			for(size_t i = 0; i < this->count; i++)
+			{
+				size_t p = this->added[i];
+				
+				if(this->shift > 0)
+				{
+					size_t b = i * this->shift;
+					unsigned long long v = p & ((1ULL << this->shift) - 1);
+					this->lows[b / 64] |= v << (b % 64);
+					if(b % 64 + this->shift > 64)
+						this->lows[b / 64 + 1] |= v >> (64 - b % 64);
+				}
+				
+				this->high.set((p >> this->shift) + i);
+			}
+			
+			// One clear bit closes every bucket of high bits, up to top
+			while(this->high.size() < this->count + this->top + 1)
+			{
+				this->high.push_back(false);
+			}
+			this->high.build();
+			
+			// The plain positions are not needed any more
+			std::vector<pdaOffset>().swap(this->added);
+		};
+		
+		// Remove every position, keeping the capacity of the coded ones for reuse
+		void clear()
+		{
+			this->added.clear();
+			this->high.clear();
+			this->lows.clear();
+			this->shift = 0;
+			this->count = 0;
+			this->top = 0;
+		};
+		
+		// Get the number of positions before p
+		size_t rank(size_t p) const
+		{
+			size_t h = p >> this->shift;
+			if(this->count == 0 || h > this->top)
+				return this->count;
+			
+			// Positions with the same high bits as p, found with the clear bits around their bucket
+			size_t from = (h == 0) ? 0 : this->high.select0(h - 1) - (h - 1);
+			size_t to = this->high.select0(h) - h;
+			size_t l = p & ((1ULL << this->shift) - 1);
+			
+			// Then the first of them with low bits of at least those of p
+			while(from < to)
+			{
+				size_t mid = (from + to) / 2;
+				if(this->low(mid) < l)
+					from = mid + 1;
+				else
+					to = mid;
+			}
+			
+			return from;
+		};
+		
+		// Get position k, counting from 0 (k must be less than size())
+		size_t select(size_t k) const
+		{
+			return ((this->high.select(k) - k) << this->shift) | this->low(k);
+		};
+		
+		// Check if p is one of the positions
+		bool contains(size_t p) const
+		{
+			size_t k = this->rank(p);
+			return k < this->count && this->select(k) == p;
+		};
+		
+		// Get the number of positions
+		size_t size() const
+		{
+			return this->count;
+		};
+};
+
+
+/************************************************
+ * Index of which delimiter matches which, built while parsing
+ * Pass it to parse() as the handler, then build() it:
+ *   PDAMatchIndex ix; pda.parse(ix); ix.build();
+ * Delimiters are kept as balanced parentheses, one bit each (1 opens, 0 closes),
+ * with the lowest depth of every 64 of them in a tree for searching;
+ * where they are in the source is kept in a PDAPositions
+ * depthAt() costs O(log n) for n delimiters, matchOf() and parentOf() O(log n)
+ * plus a scan of at most 64 delimiters on either side of the answer
+ ************************************************/
+class PDAMatchIndex : public PDAHandler
+{
+	private:
+		PDAPositions marks;              // Source position of every delimiter that opened or closed a block
+		PDABits bp;                      // One bit per delimiter in source order, set if it opened a block
+		size_t words;                    // Number of runs of 64 delimiter counts, depths being searched run by run
+		size_t leaves;                   // Leaves of the tree, the least power of 2 not below words
+		std::vector<int> low;            // Tree of the lowest depth of each run, leaves from index leaves on
+		
+		/*******************************************
+		 * Private Functions
+		 *******************************************/
+		
+		// Get the depth of the stack after the first c delimiters
+		long long depth(size_t c) const
+		{
+			return 2 * (long long)this->bp.rank(c) - (long long)c;
+		};
+		
+		// Get the first run of at least w with a depth of at most d, words if none
+		size_t firstRun(size_t w, long long d) const
+		{
+			if(w >= this->words)
+				return this->words;
+			
+			size_t v = this->leaves + w;
+			if(this->low[v] <= d)
+				return w;
+			
+			// Climb until a right sibling holds such a depth
+			for(;;)
+			{
+				if(v == 1)
+					return this->words;
+				if(v % 2 == 0 && this->low[v + 1] <= d)
+					break;
+				v /= 2;
+			}
+			
+			// Then go down to its leftmost leaf that does
+			v += 1;
+			while(v < this->leaves)
+			{
+				v = (this->low[2 * v] <= d) ? 2 * v : 2 * v + 1;
+			}
+			
+			return v - this->leaves;
+		};
+		
+		// Get the last run of at most w with a depth of at most d, npos if none
+		size_t lastRun(size_t w, long long d) const
+		{
+			size_t v = this->leaves + w;
+			if(this->low[v] <= d)
+				return w;
+			
+			// Climb until a left sibling holds such a depth
+			for(;;)
+			{
+				if(v == 1)
+					return npos;
+				if(v % 2 == 1 && this->low[v - 1] <= d)
+					break;
+				v /= 2;
+			}
+			
+			// Then go down to its rightmost leaf that does
+			v -= 1;
+			while(v < this->leaves)
+			{
+				v = (this->low[2 * v + 1] <= d) ? 2 * v + 1 : 2 * v;
+			}
+			
+			return v - this->leaves;
+		};
+		
+		// Get the first count c of at least from with depth(c) at most d, npos if none
+		size_t forward(size_t c, long long d) const
+		{
+			long long D = this->depth(c);
+			
+			for(;;)
+			{
+				if(D <= d)
+					return c;
+				if(c >= this->bp.size())
+					return npos;
+				
+				D += this->bp[c] ? 1 : -1;
+				c++;
+				
+				// Jump over whole runs that stay too deep
+				if(c % 64 == 0)
+				{
+					size_t w = this->firstRun(c / 64, d);
+					if(w >= this->words)
+						return npos;
+					
+					if(w != c / 64)
+					{
+						c = w * 64;
+						D = this->depth(c);
+					}
+				}
+			}
+		};
+		
+		// Get the last count c of at most from with depth(c) at most d, npos if none
+		size_t backward(size_t c, long long d) const
+		{
+			long long D = this->depth(c);
+			
+			for(;;)
+			{
+				if(D <= d)
+					return c;
+				if(c == 0)
+					return npos;
+				
+				// Jump over whole runs that stay too deep
+				if(c % 64 == 0)
+				{
+					size_t w = this->lastRun(c / 64 - 1, d);
+					if(w == npos)
+						return npos;
+					
+					c = w * 64 + 63;
+					D = this->depth(c);
+					continue;
+				}
+				
+				c--;
+				D -= this->bp[c] ? 1 : -1;
+			}
+		};
+		
+		// Get the opening delimiter of the innermost block at depth e, looking back from the first c delimiters
+		size_t opener(size_t c, long long e) const
+		{
+			if(e <= 0 || c == 0)
+				return npos;
+			
+			// The last time the depth rose from e - 1 to e
+			return this->backward(c - 1, e - 1);
+		};
+	
+	public:
+		// Returned when there is no such position
+		static constexpr size_t npos = (size_t)-1;
+		
+		/* Constructor */
+		PDAMatchIndex()
+		{
+			this->words = 0;
+			this->leaves = 0;
+		};
+		
+		/*******************************************
+		 * Events, see PDAHandler
+		 *******************************************/
+		
+		void onOpen(unsigned int /*delim*/, size_t pos)
+		{
+			this->marks.push_back(pos);
+			this->bp.push_back(true);
+		};
+		
+		void onClose(unsigned int /*delim*/, size_t pos)
+		{
+			this->marks.push_back(pos);
+			this->bp.push_back(false);
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Finish the index once parsing is done, so it can be queried
+		void build()
+		{
+			this->marks.build();
+			this->bp.build();
+			
+			// Lowest depth of every run of 64 counts, over counts 0 to size()
+			this->words = this->bp.size() / 64 + 1;
+			this->leaves = 1;
+			while(this->leaves < this->words)
+			{
+				this->leaves *= 2;
+			}
+			
+			this->low.assign(2 * this->leaves, INT_MAX);
+			for(size_t w = 0; w < this->words; w++)
+			{
+				long long D = this->depth(w * 64);
+				long long m = D;
+				
+				for(size_t c = w * 64; c < w * 64 + 63 && c < this->bp.size(); c++)
+				{
+					D += this->bp[c] ? 1 : -1;
+					m = std::min(m, D);
+				}
+				
+				this->low[this->leaves + w] = (int)m;
+			}
+			
+			for(size_t v = this->leaves - 1; v > 0; v--)
+			{
+				this->low[v] = std::min(this->low[2 * v], this->low[2 * v + 1]);
+			}
+		};
+		
+		// Remove everything, keeping the capacity for reuse
+		void clear()
+		{
+			this->marks.clear();
+			this->bp.clear();
+			this->low.clear();
+			this->words = 0;
+			this->leaves = 0;
+		};
+		
+		// Get the position of the delimiter matching the one at pos, npos if pos holds no delimiter or it was never matched
+		size_t matchOf(size_t pos) const
+		{
+			size_t k = this->marks.rank(pos);
+			if(k >= this->marks.size() || this->marks.select(k) != pos)
+				return npos;
+			
+			size_t c;
+			
+			if(this->bp[k])
+			{
+				// Closed by the first delimiter after which the depth is back to what it was before this one
+				c = this->forward(k + 1, this->depth(k));
+				if(c == npos)
+					return npos;
+				c -= 1;
+			}
+			else
+			{
+				// Opened by the last delimiter before which the depth was what it is after this one
+				c = this->backward(k, this->depth(k + 1));
+			}
+			
+			return this->marks.select(c);
+		};
+		
+		// Get the position of the opening delimiter of the block holding pos, npos at the top level
+		// For a delimiter, that is the block around the one it opens or closes
+		size_t parentOf(size_t pos) const
+		{
+			size_t k = this->marks.rank(pos);
+			
+			if(k < this->marks.size() && this->marks.select(k) == pos)
+			{
+				// Start from the opening delimiter of this block
+				if(!this->bp[k])
+					k = this->backward(k, this->depth(k + 1));
+				
+				size_t c = this->opener(k, this->depth(k));
+				return (c == npos) ? npos : this->marks.select(c);
+			}
+			
+			size_t c = this->opener(k, this->depth(k));
+			return (c == npos) ? npos : this->marks.select(c);
+		};
+		
+		// Get the depth of the stack once the element at pos has been read
+		size_t depthAt(size_t pos) const
+		{
+			return (size_t)this->depth(this->marks.rank(pos + 1));
+		};
+		
+		// Get the number of delimiters indexed
+		size_t size() const
+		{
+			return this->bp.size();
+		};
+};
+
+
+#endif
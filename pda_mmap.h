@@ -0,0 +1,180 @@
+#ifndef PDA_MMAP_H
+#define PDA_MMAP_H
+
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+/************************************************
+ * Read-only memory-mapped file
+ * Give view() to PDA<std::string> to parse the file in place,
+ * tokens read with readNextView() then point into the mapped pages
+ ************************************************/
+class PDAMappedFile
+{
+	private:
+		const char* first;               // Start of the mapping, NULL if nothing is mapped
+		size_t count;                    // Size of the file
+		size_t released;                 // Bytes at the start of the mapping already handed back to the OS
+		size_t page;                     // Page size, release() only works on whole pages
+		bool open;                       // True if the file could be opened, even if it is empty
+		
+#if defined(_WIN32)
+		HANDLE file;
+		HANDLE map;
+#else
+		int fd;
+#endif
+		
+		// Mappings cannot be shared between objects
+		PDAMappedFile(const PDAMappedFile&);
+		PDAMappedFile& operator=(const PDAMappedFile&);
+		
+	public:
+		/* Constructor */
+		PDAMappedFile(const std::string& path)
+		{
+			this->first = NULL;
+			this->count = 0;
+			this->released = 0;
+			this->open = false;
+			
+#if defined(_WIN32)
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			this->page = info.dwAllocationGranularity;
+			this->map = NULL;
+			
+			this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if(this->file == INVALID_HANDLE_VALUE)
+			{
+				std::cout << "[Error] Could not open " << path << "\n";
+				return;
+			}
+			
+			LARGE_INTEGER size;
+			GetFileSizeEx(this->file, &size);
+			this->count = (size_t)size.QuadPart;
+			this->open = true;
+			
+			// An empty file cannot be mapped, but it can still be parsed
+			if(this->count == 0)
+				return;
+			
+			this->map = CreateFileMappingA(this->file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if(this->map != NULL)
+				this->first = (const char*)MapViewOfFile(this->map, FILE_MAP_READ, 0, 0, 0);
+#else
+			this->page = (size_t)sysconf(_SC_PAGESIZE);
+			
+			this->fd = ::open(path.c_str(), O_RDONLY);
+			if(this->fd < 0)
+			{
+				std::cout << "[Error] Could not open " << path << "\n";
+				return;
+			}
+			
+			struct stat st;
+			fstat(this->fd, &st);
+			this->count = (size_t)st.st_size;
+			this->open = true;
+			
+			// An empty file cannot be mapped, but it can still be parsed
+			if(this->count == 0)
+				return;
+			
+			void* m = mmap(NULL, this->count, PROT_READ, MAP_PRIVATE, this->fd, 0);
+			if(m != MAP_FAILED)
+			{
+				this->first = (const char*)m;
+				
+				// The automata reads front to back, so read ahead aggressively and drop pages behind it
+				madvise(m, this->count, MADV_SEQUENTIAL);
+			}
+#endif
+			
+			if(this->first == NULL)
+			{
+				std::cout << "[Error] Could not map " << path << "\n";
+				this->count = 0;
+				this->open = false;
+			}
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Check if the file was opened and mapped
+		bool isOpen()
+		{
+			return this->open;
+		};
+		
+		// Get the contents of the file
+		std::string_view view()
+		{
+			if(this->first == NULL)
+				return std::string_view();
+			
+			return std::string_view(this->first, this->count);
+		};
+		
+		// Get the size of the file
+		size_t size()
+		{
+			return this->count;
+		};
+		
+		// Hand the pages before offset upTo back to the OS, so resident memory stays near what is still being read
+		// Views into those pages stay valid, they are read back from the file if they are used again
+		void release(size_t upTo)
+		{
+			if(this->first == NULL)
+				return;
+			
+			if(upTo > this->count)
+				upTo = this->count;
+			
+			// Only whole pages can be dropped
+			upTo -= upTo % this->page;
+			if(upTo <= this->released)
+				return;
+				
+#if defined(_WIN32)
+			VirtualUnlock((LPVOID)(this->first + this->released), upTo - this->released);
+#else
+			madvise((void*)(this->first + this->released), upTo - this->released, MADV_DONTNEED);
+#endif
+			
+			this->released = upTo;
+		};
+		
+		/* Destructor */
+		~PDAMappedFile()
+		{
+#if defined(_WIN32)
+			if(this->first != NULL)
+				UnmapViewOfFile(this->first);
+			if(this->map != NULL)
+				CloseHandle(this->map);
+			if(this->file != INVALID_HANDLE_VALUE)
+				CloseHandle(this->file);
+#else
+			if(this->first != NULL)
+				munmap((void*)this->first, this->count);
+			if(this->fd >= 0)
+				close(this->fd);
+#endif
+		};
+};
+
+
+#endif
@@ -0,0 +1,567 @@
+#ifndef PDA_PARALLEL_H
+#define PDA_PARALLEL_H
+
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include "pda_grammar.h"
+
+// Fewest characters given to each thread by pdaValidate(), smaller sources use fewer threads
+#ifndef PDA_MIN_CHUNK
+	#define PDA_MIN_CHUNK 65536
+#endif
+
+// Inputs a PDABatch worker takes from its range at a time
+#ifndef PDA_BATCH_BLOCK
+	#define PDA_BATCH_BLOCK 64
+#endif
+
+
+/************************************************
+ * Outcome of validating a source without reading its tokens
+ * err and pos are the error code and position a PDA over the same source would stop with
+ ************************************************/
+class PDAResult
+{
+	public:
+		int err;                         // Error code, 0 if the delimiters are balanced
+		size_t pos;                      // Position the automata stopped at, the length of the source if err is 0
+		size_t depth;                    // Deepest the stack got before stopping
+		
+		PDAResult()
+		{
+			this->err = 0;
+			this->pos = 0;
+			this->depth = 0;
+		};
+};
+
+
+/************************************************
+ * Summary of one chunk of a source, validated on its own
+ * Delimiters matched inside the chunk are dropped; closing delimiters left over
+ * must match the stack coming into the chunk, opening delimiters left over go onto it
+ * A symmetric delimiter with nothing of the chunk's own under it closes only if the incoming stack has it on top there,
+ * and a quoted delimiter on top of the incoming stack starts the chunk inside its block,
+ * so scan() is told what the incoming stack holds on top, or all of it
+ ************************************************/
+template <typename CharT>
+class PDAChunk
+{
+	public:
+		typedef std::pair<unsigned int, size_t> Delim;  // Index into pairs and position of a delimiter
+		
+		std::vector<Delim> closers;      // Closing delimiters that found the chunk's own stack empty, in order
+		std::vector<Delim> openers;      // Opening delimiters still open at the end of the chunk, in order
+		
+		// Positions at which the depth before an opening delimiter, relative to the start of the chunk, first reaches a new high
+		// The first entry whose depth reaches maxDepth less the incoming depth is where the stack would be too deep
+		std::vector<std::pair<long long, size_t> > highs;
+		
+		// Symmetric delimiters taken as opening while the incoming delimiter under them was not known,
+		// each with the number of incoming delimiters closed before it instead of a position
+		std::vector<Delim> guesses;
+		
+		int err;                         // Error found within the chunk alone, 0 if none
+		size_t pos;                      // Position of that error, the scan stopped there
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Get in o the incoming delimiter under the chunk's own stack once k incoming ones are closed, PDA_PLAIN if there is none
+		// Returns false if that is not known, which only the top of the incoming stack is unless all of it is given
+		static bool outer(size_t k, unsigned int top, const std::vector<Delim>* stack, unsigned int& o)
+		{
+			if(stack != NULL)
+			{
+				o = (k < stack->size()) ? (*stack)[stack->size() - 1 - k].first : PDA_PLAIN;
+				return true;
+			}
+			
+			o = (k == 0) ? top : PDA_PLAIN;
+			return k == 0;
+		};
+		
+		// Validate s[from, to) on its own, esc telling if s[from] is escaped
+		// top is the delimiter on top of the incoming stack, PDA_PLAIN if it is neither quoted nor symmetric;
+		// if stack is given it is the whole incoming stack instead, and nothing is guessed
+		void scan(const CharT* s, size_t from, size_t to, bool esc, const PDAGrammar<CharT>& g, size_t maxDepth, unsigned int top, const std::vector<Delim>* stack)
+		{
+			long long rel = 0;               // Depth relative to the start of the chunk
+			size_t i = from;
+			
+			this->closers.clear();
+			this->openers.clear();
+			this->highs.clear();
+			this->guesses.clear();
+			this->err = 0;
+			this->pos = to;
+			
+			if(esc)
+				i++;
+			
+			while(i < to)
+			{
+				// Incoming delimiter under the chunk's own stack, if it is known
+				unsigned int o;
+				bool known = outer(this->closers.size(), top, stack, o);
+				
+				// Inside a quoted block only its closing delimiter and the escape count
+				unsigned int q = PDA_PLAIN;
+				if(!this->openers.empty())
+				{
+					if(g.quoted(this->openers.back().first))
+						q = this->openers.back().first;
+				}
+				else if(o != PDA_PLAIN && g.quoted(o))
+				{
+					q = o;
+				}
+				
+				// Jump to the next escape or delimiter
+				i += (q == PDA_PLAIN) ? g.find(s + i, to - i) : g.findIn(q, s + i, to - i);
+				if(i >= to)
+					break;
+				
+				unsigned int c;
+				bool cut;
+				size_t w = (q == PDA_PLAIN) ? g.match(s + i, to - i, c, cut) : g.matchIn(q, s + i, to - i, c, cut);
+				
+				if(c == PDA_PLAIN) // Only the start of a longer delimiter
+				{
+					i++;
+					continue;
+				}
+				
+				if(c == 0) // Escape, skip the character after it
+				{
+					i += w + 1;
+					continue;
+				}
+				
+				if(c % 2 == 1 && g.symmetric(c) && this->openers.empty() && o == c)
+				{
+					// Symmetric delimiter closing the same one on the incoming stack
+					this->closers.push_back(Delim(c + 1, i));
+					rel--;
+				}
+				else if(c % 2 == 1 && !(g.symmetric(c) && !this->openers.empty() && this->openers.back().first == c))
+				{
+					// A symmetric one resting on an incoming delimiter not known here, join() checks that it is not the same
+					if(g.symmetric(c) && this->openers.empty() && !known)
+						this->guesses.push_back(Delim(c, this->closers.size()));
+					
+					// Opening delimiter; deeper than maxDepth no matter what comes into the chunk
+					if(rel >= (long long)maxDepth)
+					{
+						this->err = -4;
+						this->pos = i;
+						return;
+					}
+					
+					if(this->highs.empty() || rel > this->highs.back().first)
+						this->highs.push_back(std::make_pair(rel, i));
+					
+					this->openers.push_back(Delim(c, i));
+					rel++;
+				}
+				else if(this->openers.empty())
+				{
+					// Closing delimiter, left for the stack coming into the chunk
+					this->closers.push_back(Delim(c, i));
+					rel--;
+				}
+				else if(this->openers.back().first == c - (c % 2 == 0 ? 1 : 0))
+				{
+					// Closing delimiter matching the chunk's own stack
+					this->openers.pop_back();
+					rel--;
+				}
+				else
+				{
+					// Closing delimiter that does not pair with the one before it
+					this->err = -3;
+					this->pos = i;
+					return;
+				}
+				
+				i += w;
+			}
+		};
+		
+		// Check that stack, built by what comes before the chunk, holds none of the delimiters scan() took as opening under them
+		bool holds(const std::vector<Delim>& stack) const
+		{
+			for(size_t i = 0; i < this->guesses.size(); i++)
+			{
+				size_t k = this->guesses[i].second;
+				
+				if(k < stack.size() && stack[stack.size() - 1 - k].first == this->guesses[i].first)
+					return false;
+			}
+			
+			return true;
+		};
+		
+		// Carry stack, built by what comes before the chunk, through the chunk as a PDA reading on would
+		// Returns false at the first error, which is then given in out
+		bool join(std::vector<Delim>& stack, size_t maxDepth, PDAResult& out) const
+		{
+			size_t in = stack.size();
+			
+			// Earliest error, starting with the one found in the chunk alone
+			int e = this->err;
+			size_t at = this->pos;
+			
+			// The first opening delimiter to reach maxDepth
+			if(in <= maxDepth)
+			{
+				typename std::vector<std::pair<long long, size_t> >::const_iterator h = std::lower_bound(this->highs.begin(), this->highs.end(), std::make_pair((long long)(maxDepth - in), (size_t)0));
+				if(h != this->highs.end() && h->second < at)
+				{
+					e = -4;
+					at = h->second;
+				}
+			}
+			
+			// The first closing delimiter that does not pair with the incoming stack
+			for(size_t i = 0; i < this->closers.size() && this->closers[i].second < at; i++)
+			{
+				size_t top = in - i - 1;
+				
+				if(i >= in)
+				{
+					e = -1;
+					at = this->closers[i].second;
+				}
+				else if(stack[top].first != this->closers[i].first - 1)
+				{
+					e = -3;
+					at = this->closers[i].second;
+				}
+			}
+			
+			// Deepest the stack got in this chunk, up to the error if there is one
+			for(size_t i = 0; i < this->highs.size() && this->highs[i].second < at; i++)
+			{
+				out.depth = std::max(out.depth, (size_t)(in + this->highs[i].first + 1));
+			}
+			
+			if(e < 0)
+			{
+				out.err = e;
+				out.pos = at;
+				return false;
+			}
+			
+			stack.resize(in - this->closers.size());
+			stack.insert(stack.end(), this->openers.begin(), this->openers.end());
+			
+			return true;
+		};
+};
+
+
+/************************************************
+ * Parallel validation of a whole source
+ * The source is split into one chunk per thread, every chunk is reduced to a PDAChunk on its own,
+ * then the summaries are joined in order to find the first error
+ ************************************************/
+
+// Check if s[at] is escaped, from the run of escape characters just before it
+template <typename CharT>
+bool pdaEscapedAt(const CharT* s, size_t at, const PDAGrammar<CharT>& g)
+{
+	size_t run = 0;
+	
+	while(run < at && g.classify(s[at - run - 1]) == 0)
+	{
+		run++;
+	}
+	
+	// Escapes pair off, the last one escapes s[at] if the run is odd
+	return run % 2 == 1;
+}
+
+// Scan s[from, to) into chunks[t] once for each tops[t] that could be on top of the stack coming into it
+template <typename CharT>
+void pdaScanTops(std::vector<PDAChunk<CharT> >* chunks, const std::vector<unsigned int>* tops, const CharT* s, size_t from, size_t to, const PDAGrammar<CharT>* g, size_t maxDepth)
+{
+	bool esc = pdaEscapedAt(s, from, *g);
+	
+	for(size_t t = 0; t < tops->size(); t++)
+	{
+		(*chunks)[t].scan(s, from, to, esc, *g, maxDepth, (*tops)[t], NULL);
+	}
+}
+
+// Check delimiters in src are balanced, using up to threads threads (0 for one per core)
+// Gives the error code and position PDA<std::basic_string<CharT> > would stop at, without printing anything
+// Every chunk but the first is scanned once more for each quoted or symmetric pair, as either could be open when it starts,
+// so such pairs only pay off with more threads than that; a grammar with a delimiter longer than one character is checked on one thread,
+// as a chunk could start partway through one
+template <typename CharT>
+PDAResult pdaValidate(std::basic_string_view<CharT> src, const PDAGrammar<CharT>& g, size_t maxDepth = PDA_MAX_DEPTH, unsigned int threads = 0)
+{
+	const CharT* s = src.data();
+	size_t len = src.length();
+	
+	if(threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	
+	// Delimiters that change how a chunk reads when they are on top of the stack coming into it, PDA_PLAIN standing for any other
+	std::vector<unsigned int> tops(1, PDA_PLAIN);
+	for(unsigned int i = 1; i + 1 < g.size(); i += 2)
+	{
+		if(g.quoted(i) || g.symmetric(i))
+			tops.push_back(i);
+	}
+	
+	size_t n = std::max((size_t)1, std::min((size_t)threads, len / PDA_MIN_CHUNK));
+	if(g.isMulti() || n <= tops.size())
+		n = 1;
+	
+	// Reduce every chunk on its own, the first one from an empty stack
+	std::vector<std::vector<PDAChunk<CharT> > > chunks(n, std::vector<PDAChunk<CharT> >(tops.size()));
+	std::vector<typename PDAChunk<CharT>::Delim> stack;
+	std::vector<std::thread> workers;
+	
+	for(size_t k = 1; k < n; k++)
+	{
+		size_t from = len / n * k;
+		size_t to = (k + 1 == n) ? len : len / n * (k + 1);
+		
+		workers.push_back(std::thread(&pdaScanTops<CharT>, &chunks[k], &tops, s, from, to, &g, maxDepth));
+	}
+	
+	chunks[0][0].scan(s, 0, (n == 1) ? len : len / n, false, g, maxDepth, PDA_PLAIN, &stack);
+	
+	for(size_t k = 0; k < workers.size(); k++)
+	{
+		workers[k].join();
+	}
+	
+	// Join the summaries in order, carrying the stack from chunk to chunk
+	PDAResult out;
+	
+	for(size_t k = 0; k < n; k++)
+	{
+		// The scan made for what is on top of the stack now
+		size_t t = 0;
+		if(k > 0 && !stack.empty())
+		{
+			t = std::find(tops.begin(), tops.end(), stack.back().first) - tops.begin();
+			if(t == tops.size())
+				t = 0;
+		}
+		
+		PDAChunk<CharT>& c = chunks[k][t];
+		
+		// Scan again knowing the whole stack if it took a symmetric delimiter the wrong way
+		if(!c.holds(stack))
+		{
+			size_t from = len / n * k;
+			size_t to = (k + 1 == n) ? len : len / n * (k + 1);
+			
+			c.scan(s, from, to, pdaEscapedAt(s, from, g), g, maxDepth, PDA_PLAIN, &stack);
+		}
+		
+		if(!c.join(stack, maxDepth, out))
+			return out;
+	}
+	
+	// Unclosed delimiter error
+	if(!stack.empty())
+		out.err = -2;
+	
+	out.pos = len;
+	return out;
+}
+
+
+/************************************************
+ * Validation of many small sources on every core
+ * Every worker starts with an even share of the inputs and, once done,
+ * steals half of what is left of another worker's share
+ * Workers keep their state from batch to batch, so once it has grown nothing is allocated per input
+ ************************************************/
+template <typename CharT>
+class PDABatch
+{
+	private:
+		typedef std::basic_string_view<CharT> View;
+		
+		// State of one worker thread
+		class Worker
+		{
+			public:
+				std::mutex lock;                                         // Guards next and end, which other workers steal from
+				size_t next;                                             // First input of the share not taken yet
+				size_t end;                                              // One past the last input of the share
+				PDAChunk<CharT> chunk;                                   // Reused for every input
+				std::vector<typename PDAChunk<CharT>::Delim> stack;      // Reused for every input
+		};
+		
+		const PDAGrammar<CharT>* g;                  // Grammar of every input, kept alive by the caller
+		size_t maxDepth;                             // Most delimiters the stack may hold, as in PDA::setMaxDepth()
+		std::vector<std::unique_ptr<Worker> > all;   // One per thread
+		
+		// Batches cannot be shared between objects
+		PDABatch(const PDABatch&);
+		PDABatch& operator=(const PDABatch&);
+		
+		// Every later validate() reads the grammar, so a temporary one is refused
+		PDABatch(const PDAGrammar<CharT>&& gr, unsigned int threads);
+		
+		/*******************************************
+		 * Private Functions
+		 *******************************************/
+		
+		// Take the next block of w's own share
+		bool take(Worker& w, size_t& from, size_t& to)
+		{
+			std::lock_guard<std::mutex> hold(w.lock);
+			
+			if(w.next >= w.end)
+				return false;
+			
+			from = w.next;
+			to = std::min(w.end, w.next + PDA_BATCH_BLOCK);
+			w.next = to;
+			return true;
+		};
+		
+		// Move the back half of another worker's share into w's
+		bool steal(size_t self)
+		{
+			for(size_t k = 1; k < this->all.size(); k++)
+			{
+				Worker& v = *this->all[(self + k) % this->all.size()];
+				size_t from, to;
+				
+				{
+					std::lock_guard<std::mutex> hold(v.lock);
+					
+					if(v.next >= v.end)
+						continue;
+					
+					// A share of one input is taken whole
+					from = v.next + (v.end - v.next) / 2;
+					to = v.end;
+					v.end = from;
+				}
+				
+				std::lock_guard<std::mutex> hold(this->all[self]->lock);
+				this->all[self]->next = from;
+				this->all[self]->end = to;
+				return true;
+			}
+			
+			return false;
+		};
+		
+		// Validate inputs until none are left anywhere
+		void work(size_t self, PDASpan<View> in, PDAResult* out)
+		{
+			Worker& w = *this->all[self];
+			size_t from, to;
+			
+			while(this->take(w, from, to) || (this->steal(self) && this->take(w, from, to)))
+			{
+				for(size_t i = from; i < to; i++)
+				{
+					View s = in[i];
+					
+					w.stack.clear();
+					w.chunk.scan(s.data(), 0, s.length(), false, *this->g, this->maxDepth, PDA_PLAIN, &w.stack);
+					out[i] = PDAResult();
+					
+					if(w.chunk.join(w.stack, this->maxDepth, out[i]))
+					{
+						// Unclosed delimiter error
+						if(!w.stack.empty())
+							out[i].err = -2;
+						
+						out[i].pos = s.length();
+					}
+				}
+			}
+		};
+	
+	public:
+		/* Constructor */
+		
+		// threads is the number of worker threads (0 for one per core)
+		// Each input is read as one chunk from an empty stack, so unlike pdaValidate() any grammar works
+		PDABatch(const PDAGrammar<CharT>& gr, unsigned int threads)
+		{
+			this->g = &gr;
+			this->maxDepth = PDA_MAX_DEPTH;
+			
+			if(threads == 0)
+				threads = std::max(1u, std::thread::hardware_concurrency());
+			
+			for(unsigned int t = 0; t < threads; t++)
+			{
+				this->all.push_back(std::unique_ptr<Worker>(new Worker()));
+			}
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Check every input for balanced delimiters, out[i] being given the result for in[i]
+		// out must have room for in.size() results; each is what pdaValidate() would give for that input
+		void validate(PDASpan<View> in, PDAResult* out)
+		{
+			size_t n = std::min(this->all.size(), (in.size() + PDA_BATCH_BLOCK - 1) / PDA_BATCH_BLOCK);
+			
+			// Even shares to start with
+			for(size_t t = 0; t < this->all.size(); t++)
+			{
+				this->all[t]->next = (t < n) ? in.size() / n * t : 0;
+				this->all[t]->end = (t < n) ? ((t + 1 == n) ? in.size() : in.size() / n * (t + 1)) : 0;
+			}
+			
+			std::vector<std::thread> workers;
+			for(size_t t = 1; t < n; t++)
+			{
+				workers.push_back(std::thread(&PDABatch::work, this, t, in, out));
+			}
+			
+			if(n > 0)
+				this->work(0, in, out);
+			
+			for(size_t t = 0; t < workers.size(); t++)
+			{
+				workers[t].join();
+			}
+		};
+		
+		// Set the most delimiters the stack may hold for every input
+		void setMaxDepth(size_t depth)
+		{
+			this->maxDepth = depth;
+		};
+		
+		// Get the most delimiters the stack may hold for every input
+		size_t getMaxDepth()
+		{
+			return this->maxDepth;
+		};
+		
+		/* Destructor */
+		~PDABatch()
+		{
+			// Every worker is owned through all
+		};
+};
+
+
+#endif
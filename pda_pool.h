@@ -0,0 +1,84 @@
+#ifndef PDA_POOL_H
+#define PDA_POOL_H
+
+
+#include <memory>
+#include <string_view>
+
+#include "pda_grammar.h"
+
+/************************************************
+ * Pool of ready string PDAs over one grammar
+ * Finished PDAs are handed back and reset() for the next source instead of being destroyed,
+ * so once the pool has warmed up a parse allocates nothing
+ * Not synchronised: give each thread its own pool, e.g. thread_local PDAPool<char> pool(g, false);
+ ************************************************/
+template <typename CharT>
+class PDAPool
+{
+	private:
+		typedef PDA<std::basic_string<CharT> > Automata;
+		
+		const PDAGrammar<CharT>* g;                 // Grammar every PDA in the pool reads, kept alive by the caller
+		bool noisy;                                  // Passed on to every PDA in the pool
+		std::vector<std::unique_ptr<Automata> > all; // Every PDA the pool has made
+		std::vector<Automata*> idle;                 // PDAs handed back and ready for another source
+		
+		// Pools cannot be shared between objects
+		PDAPool(const PDAPool&);
+		PDAPool& operator=(const PDAPool&);
+		
+		// Nor kept on a temporary grammar, which every PDA of the pool would outlive
+		PDAPool(const PDAGrammar<CharT>&& gr, bool n);
+	
+	public:
+		/* Constructor */
+		PDAPool(const PDAGrammar<CharT>& gr, bool n)
+		{
+			this->g = &gr;
+			this->noisy = n;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Get a PDA reading src in place, reusing one that was handed back if there is any
+		// The caller must keep src alive until the PDA is handed back
+		Automata* acquire(std::basic_string_view<CharT> src)
+		{
+			if(this->idle.empty())
+			{
+				this->all.push_back(std::unique_ptr<Automata>(new Automata(*this->g, this->noisy)));
+				this->idle.reserve(this->all.capacity());
+				this->all.back()->reset(src);
+				return this->all.back().get();
+			}
+			
+			Automata* p = this->idle.back();
+			this->idle.pop_back();
+			p->reset(src);
+			return p;
+		};
+		
+		// Hand a PDA from acquire() back to the pool
+		void release(Automata* p)
+		{
+			this->idle.push_back(p);
+		};
+		
+		// Get the number of PDAs the pool has made
+		size_t size()
+		{
+			return this->all.size();
+		};
+		
+		/* Destructor */
+		~PDAPool()
+		{
+			// Every PDA is owned through all
+		};
+};
+
+
+#endif
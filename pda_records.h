@@ -0,0 +1,189 @@
+#ifndef PDA_RECORDS_H
+#define PDA_RECORDS_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "pda_grammar.h"
+#include "pda_parallel.h"
+
+/************************************************
+ * Source made of independent top-level records, e.g. {...}{...}{...}
+ * split() finds where each record opens and closes at depth 0,
+ * run() then hands every record to a worker thread with a PDA of its own
+ * Characters between records (e.g. newlines) belong to no record
+ ************************************************/
+template <typename CharT>
+class PDARecords
+{
+	private:
+		typedef PDA<std::basic_string<CharT> > Automata;
+		typedef std::basic_string_view<CharT> View;
+		
+		const PDAGrammar<CharT>* g;                      // Grammar of the source and of every record, kept alive by the caller
+		unsigned int threads;                            // Worker threads used by run()
+		bool ordered;                                    // True if run() delivers results in input order
+		View source;                                     // Source last split, kept alive by the caller
+		std::vector<std::pair<size_t, size_t> > bounds;  // Start of each record and one past its end
+		
+		// The grammar is read again by run(), so it cannot be a temporary
+		PDARecords(const PDAGrammar<CharT>&& gr, unsigned int t, bool o);
+	
+	public:
+		/* Constructor */
+		
+		// threads is the number of worker threads (0 for one per core)
+		// ordered results are delivered in input order, otherwise as soon as each is ready
+		PDARecords(const PDAGrammar<CharT>& gr, unsigned int t, bool o)
+		{
+			this->g = &gr;
+			this->threads = (t == 0) ? std::max(1u, std::thread::hardware_concurrency()) : t;
+			this->ordered = o;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Find the records of src with a PDA of its own, reading it in place
+		// Records found before an error are kept; returns where that PDA stopped
+		PDAResult split(View src)
+		{
+			Automata a(src, *this->g, false);
+			PDAResult out;
+			size_t open = 0;
+			
+			this->source = src;
+			this->bounds.clear();
+			
+			while(a.getErr() >= 0 && a.getPos() < src.length())
+			{
+				size_t depth = a.stackDepth();
+				a.readNextDelimView();
+				
+				if(depth == 0 && a.stackDepth() > 0)
+				{
+					// A record opens with the delimiter just read, which may be several characters long
+					open = a.getPos() - this->g->text(a.lastDelim()).length();
+				}
+				else if(depth > 0 && a.stackDepth() == 0)
+				{
+					// And closes when the stack is empty again
+					this->bounds.push_back(std::make_pair(open, a.getPos()));
+				}
+				
+				out.depth = std::max(out.depth, a.stackDepth());
+			}
+			
+			out.err = a.getErr();
+			out.pos = a.getPos();
+			return out;
+		};
+		
+		// Get the number of records found by split()
+		size_t size()
+		{
+			return this->bounds.size();
+		};
+		
+		// Get record i as a view into the source
+		View record(size_t i)
+		{
+			return this->source.substr(this->bounds[i].first, this->bounds[i].second - this->bounds[i].first);
+		};
+		
+		// Split src, then run work(pda, i) for every record i on the worker threads, pda being reset() on record(i)
+		// Each result is handed to deliver(i, result) on the calling thread, in input order if ordered
+		// Every worker keeps one PDA for all its records, so nothing is allocated per record once the stacks have grown
+		template <typename Work, typename Deliver>
+		PDAResult run(View src, Work work, Deliver deliver)
+		{
+			typedef decltype(work(std::declval<Automata&>(), (size_t)0)) Result;
+			
+			PDAResult out = this->split(src);
+			size_t count = this->bounds.size();
+			
+			std::atomic<size_t> next(0);                         // Next record to hand to a worker
+			std::mutex lock;                                     // Guards done
+			std::condition_variable ready;                       // Signalled when a result is added to done
+			std::vector<std::pair<size_t, Result> > done;        // Results not delivered yet
+			
+			std::vector<std::thread> workers;
+			for(unsigned int t = 0; t < std::min((size_t)this->threads, count); t++)
+			{
+				workers.push_back(std::thread([&]() {
+					Automata a(*this->g, false);
+					
+					for(size_t i = next++; i < count; i = next++)
+					{
+						a.reset(this->record(i));
+						Result r = work(a, i);
+						
+						std::lock_guard<std::mutex> hold(lock);
+						done.push_back(std::make_pair(i, std::move(r)));
+						ready.notify_one();
+					}
+				}));
+			}
+			
+			// Deliver on this thread, holding early results back until the records before them are in if ordered
+			std::vector<std::optional<Result> > held(this->ordered ? count : 0);
+			std::vector<std::pair<size_t, Result> > batch;
+			size_t delivered = 0;
+			size_t first = 0;
+			
+			while(delivered < count)
+			{
+				{
+					std::unique_lock<std::mutex> hold(lock);
+					ready.wait(hold, [&]() { return !done.empty(); });
+					batch.swap(done);
+				}
+				
+				for(size_t k = 0; k < batch.size(); k++)
+				{
+					if(this->ordered)
+					{
+						held[batch[k].first] = std::move(batch[k].second);
+					}
+					else
+					{
+						deliver(batch[k].first, std::move(batch[k].second));
+						delivered++;
+					}
+				}
+				batch.clear();
+				
+				while(this->ordered && first < count && held[first].has_value())
+				{
+					deliver(first, std::move(*held[first]));
+					held[first].reset();
+					first++;
+					delivered++;
+				}
+			}
+			
+			for(size_t t = 0; t < workers.size(); t++)
+			{
+				workers[t].join();
+			}
+			
+			return out;
+		}
+		
+		/* Destructor */
+		~PDARecords()
+		{
+			// Nothing to do, really
+		};
+};
+
+
+#endif
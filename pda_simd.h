@@ -0,0 +1,237 @@
+#ifndef PDA_SIMD_H
+#define PDA_SIMD_H
+
+
+#include <cstddef>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	#define PDA_SIMD_X86
+	#define PDA_TARGET_SSE2 __attribute__((target("sse2")))
+	#define PDA_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <immintrin.h>
+	#include <intrin.h>
+	#define PDA_SIMD_X86
+	#define PDA_TARGET_SSE2
+	#define PDA_TARGET_AVX2
+#endif
+
+// Most distinct elements pdaFindAny() compares a block against
+// Larger delimiter sets are cheaper to scan through the class table
+#define PDA_SIMD_MAX 16
+
+
+/************************************************
+ * Vectorised search for the next element of a small set
+ * Elements may be 1, 2 or 4 bytes wide
+ ************************************************/
+
+// Index of the lowest set bit (bits must not be 0)
+inline unsigned int pdaLowBit(unsigned int bits)
+{
+#if defined(_MSC_VER)
+	unsigned long i;
+	_BitScanForward(&i, bits);
+	return (unsigned int)i;
+#else
+	return (unsigned int)__builtin_ctz(bits);
+#endif
+}
+
+// Scalar search, used on targets without SIMD and for the tail of a vectorised search
+template <typename E>
+size_t pdaFindAnyScalar(const E* s, size_t len, const E* set, unsigned int n)
+{
+	for(size_t i = 0; i < len; i++)
+	{
+		for(unsigned int k = 0; k < n; k++)
+		{
+			if(s[i] == set[k])
+				return i;
+		}
+	}
+	
+	return len;
+}
+
+#ifdef PDA_SIMD_X86
+
+// Check once whether the CPU and OS support AVX2
+inline bool pdaDetectAvx2()
+{
+#if defined(_MSC_VER)
+	int r[4];
+	__cpuid(r, 0);
+	if(r[0] < 7)
+		return false;
+	
+	// OSXSAVE and AVX, then the OS must save the YMM registers
+	__cpuid(r, 1);
+	if((r[2] & (1 << 27)) == 0 || (r[2] & (1 << 28)) == 0)
+		return false;
+	if((_xgetbv(0) & 6) != 6)
+		return false;
+	
+	__cpuidex(r, 7, 0);
+	return (r[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+inline bool pdaHasAvx2()
+{
+	static const bool avx2 = pdaDetectAvx2();
+	return avx2;
+}
+
+// 16 bytes per block
+template <typename E>
+PDA_TARGET_SSE2 size_t pdaFindAnySse2(const E* s, size_t len, const E* set, unsigned int n)
+{
+	__m128i needle[PDA_SIMD_MAX];
+	for(unsigned int k = 0; k < n; k++)
+	{
+		if(sizeof(E) == 1)
+			needle[k] = _mm_set1_epi8((char)set[k]);
+		else if(sizeof(E) == 2)
+			needle[k] = _mm_set1_epi16((short)set[k]);
+		else
+			needle[k] = _mm_set1_epi32((int)set[k]);
+	}
+	
+	const size_t step = 16 / sizeof(E);
+	size_t i = 0;
+	for(; i + step <= len; i += step)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+		__m128i hit = _mm_setzero_si128();
+		for(unsigned int k = 0; k < n; k++)
+		{
+			if(sizeof(E) == 1)
+				hit = _mm_or_si128(hit, _mm_cmpeq_epi8(block, needle[k]));
+			else if(sizeof(E) == 2)
+				hit = _mm_or_si128(hit, _mm_cmpeq_epi16(block, needle[k]));
+			else
+				hit = _mm_or_si128(hit, _mm_cmpeq_epi32(block, needle[k]));
+		}
+	
+		unsigned int bits = (unsigned int)_mm_movemask_epi8(hit);
+		if(bits != 0)
+			return i + pdaLowBit(bits) / sizeof(E);
+	}
+	
+	return i + pdaFindAnyScalar(s + i, len - i, set, n);
+}
+
+// 32 bytes per block, finishing with at most one SSE2 block
+template <typename E>
+PDA_TARGET_AVX2 size_t pdaFindAnyAvx2(const E* s, size_t len, const E* set, unsigned int n)
+{
+	__m256i needle[PDA_SIMD_MAX];
+	for(unsigned int k = 0; k < n; k++)
+	{
+		if(sizeof(E) == 1)
+			needle[k] = _mm256_set1_epi8((char)set[k]);
+		else if(sizeof(E) == 2)
+			needle[k] = _mm256_set1_epi16((short)set[k]);
+		else
+			needle[k] = _mm256_set1_epi32((int)set[k]);
+	}
+	
+	const size_t step = 32 / sizeof(E);
+	size_t i = 0;
+	for(; i + step <= len; i += step)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i hit = _mm256_setzero_si256();
+		for(unsigned int k = 0; k < n; k++)
+		{
+			if(sizeof(E) == 1)
+				hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(block, needle[k]));
+			else if(sizeof(E) == 2)
+				hit = _mm256_or_si256(hit, _mm256_cmpeq_epi16(block, needle[k]));
+			else
+				hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(block, needle[k]));
+		}
+	
+		unsigned int bits = (unsigned int)_mm256_movemask_epi8(hit);
+		if(bits != 0)
+			return i + pdaLowBit(bits) / sizeof(E);
+	}
+	
+	return i + pdaFindAnySse2(s + i, len - i, set, n);
+}
+
+// Count the bytes of s[0, len) that are not UTF-8 continuation bytes (0x80 to 0xBF), 16 at a time
+PDA_TARGET_SSE2 inline size_t pdaCountUtf8Sse2(const char* s, size_t len)
+{
+	const __m128i cont = _mm_set1_epi8((char)0xBF);
+	const __m128i zero = _mm_setzero_si128();
+	size_t out = 0;
+	size_t i = 0;
+	
+	while(i + 16 <= len)
+	{
+		// Every byte lane counts up to 255 blocks before being added up
+		__m128i sum = _mm_setzero_si128();
+		for(unsigned int k = 0; k < 255 && i + 16 <= len; k++, i += 16)
+		{
+			__m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+			sum = _mm_sub_epi8(sum, _mm_cmpgt_epi8(block, cont));
+		}
+		
+		__m128i total = _mm_sad_epu8(sum, zero);
+		out += (size_t)_mm_cvtsi128_si32(total) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+	}
+	
+	for(; i < len; i++)
+	{
+		if(((unsigned char)s[i] & 0xC0) != 0x80)
+			out++;
+	}
+	
+	return out;
+}
+
+#endif
+
+// Get the offset of the first element of s[0, len) that is equal to one of set[0, n), or len if there is none
+// n must not be greater than PDA_SIMD_MAX
+template <typename E>
+size_t pdaFindAny(const E* s, size_t len, const E* set, unsigned int n)
+{
+#ifdef PDA_SIMD_X86
+	if(sizeof(E) == 1 || sizeof(E) == 2 || sizeof(E) == 4)
+	{
+		if(pdaHasAvx2())
+			return pdaFindAnyAvx2(s, len, set, n);
+		else
+			return pdaFindAnySse2(s, len, set, n);
+	}
+#endif
+	
+	return pdaFindAnyScalar(s, len, set, n);
+}
+
+// Count the code points in the UTF-8 text s[0, len), which is the number of bytes that do not continue a code point
+inline size_t pdaCountUtf8(const char* s, size_t len)
+{
+#ifdef PDA_SIMD_X86
+	return pdaCountUtf8Sse2(s, len);
+#else
+	size_t out = 0;
+	for(size_t i = 0; i < len; i++)
+	{
+		if(((unsigned char)s[i] & 0xC0) != 0x80)
+			out++;
+	}
+	
+	return out;
+#endif
+}
+
+
+#endif
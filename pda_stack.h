@@ -0,0 +1,123 @@
+#ifndef PDA_STACK_H
+#define PDA_STACK_H
+
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Levels of nesting kept inside the PDA itself before the stack allocates
+#ifndef PDA_INLINE_DEPTH
+	#define PDA_INLINE_DEPTH 32
+#endif
+
+// Default maximum depth of nesting, deeper input is reported as an error
+// Change it per PDA with setMaxDepth()
+#ifndef PDA_MAX_DEPTH
+	#define PDA_MAX_DEPTH 65536
+#endif
+
+
+/************************************************
+ * Stack of delimiter indices
+ * The first N levels are held inline, deeper ones on the heap
+ * Indices are stored as Index while they fit, which for most grammars is a single byte;
+ * the first index that does not fit moves the whole stack to unsigned int
+ ************************************************/
+template <typename Index = unsigned char, size_t N = PDA_INLINE_DEPTH>
+class PDAStack
+{
+	private:
+		Index narrow[N];                 // First N levels
+		std::vector<Index> deep;         // Levels past N
+		std::vector<unsigned int> wide;  // Every level, once an index has not fit in Index
+		bool widened;                    // True if the levels are held in wide
+		size_t depth;                    // Number of levels
+		
+		// Move every level to wide
+		void widen()
+		{
+			this->wide.reserve(this->depth + 1);
+			for(size_t i = 0; i < this->depth; i++)
+			{
+				this->wide.push_back((*this)[i]);
+			}
+			
+			this->widened = true;
+		};
+	
+	public:
+		/* Constructor */
+		PDAStack()
+		{
+			this->widened = false;
+			this->depth = 0;
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Add an index to the top of the stack
+		void push_back(unsigned int index)
+		{
+			if(!this->widened && index > std::numeric_limits<Index>::max())
+				this->widen();
+			
+			if(this->widened)
+				this->wide.push_back(index);
+			else if(this->depth < N)
+				this->narrow[this->depth] = (Index)index;
+			else
+				this->deep.push_back((Index)index);
+			
+			this->depth += 1;
+		};
+		
+		// Remove the index at the top of the stack (the stack must not be empty)
+		void pop_back()
+		{
+			this->depth -= 1;
+			
+			if(this->widened)
+				this->wide.pop_back();
+			else if(this->depth >= N)
+				this->deep.pop_back();
+		};
+		
+		// Get the index at the top of the stack (the stack must not be empty)
+		unsigned int back() const
+		{
+			return (*this)[this->depth - 1];
+		};
+		
+		// Get the index at level i, 0 being the bottom of the stack
+		unsigned int operator[](size_t i) const
+		{
+			if(this->widened)
+				return this->wide[i];
+			
+			if(i < N)
+				return this->narrow[i];
+			
+			return this->deep[i - N];
+		};
+		
+		// Get the number of levels
+		size_t size() const
+		{
+			return this->depth;
+		};
+		
+		// Remove every level, keeping whatever the heap already holds for reuse
+		void clear()
+		{
+			this->deep.clear();
+			this->wide.clear();
+			this->widened = false;
+			this->depth = 0;
+		};
+};
+
+
+#endif
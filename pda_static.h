@@ -0,0 +1,613 @@
+#ifndef PDA_STATIC_H
+#define PDA_STATIC_H
+
+
+#include <array>
+#include <type_traits>
+
+#include "pda_simd.h"
+#include "pda_stack.h"
+
+/************************************************
+ * Delimiter pair known at compile time
+ * Open and Close may be the same character
+ ************************************************/
+template <char Open, char Close>
+class PDAPair
+{
+	public:
+		static const char open = Open;
+		static const char close = Close;
+};
+
+
+/************************************************
+ * Compile-time construction of the tables StaticPDA reads
+ ************************************************/
+
+// Escape in index 0, then each opening delimiter followed by its closing delimiter
+template <char Esc, typename... Pairs>
+constexpr std::array<char, 1 + 2 * sizeof...(Pairs)> pdaStaticLayout()
+{
+	std::array<char, 1 + 2 * sizeof...(Pairs)> out = {};
+	unsigned int i = 1;
+	
+	out[0] = Esc;
+	((out[i++] = Pairs::open, out[i++] = Pairs::close), ...);
+	
+	return out;
+}
+
+// Index of the first entry in pairs matching each byte (PDA_PLAIN if none)
+template <size_t N>
+constexpr std::array<unsigned int, 256> pdaStaticTable(const std::array<char, N>& pairs)
+{
+	std::array<unsigned int, 256> out = {};
+	
+	for(unsigned int i = 0; i < 256; i++)
+	{
+		out[i] = PDA_PLAIN;
+	}
+	
+	for(unsigned int i = N; i > 0; i--)
+	{
+		out[(unsigned char)pairs[i - 1]] = i - 1;
+	}
+	
+	return out;
+}
+
+// Number of distinct characters in pairs
+template <size_t N>
+constexpr unsigned int pdaStaticDistinct(const std::array<char, N>& pairs, const std::array<unsigned int, 256>& cls)
+{
+	unsigned int n = 0;
+	
+	for(unsigned int i = 0; i < N; i++)
+	{
+		if(cls[(unsigned char)pairs[i]] == i)
+			n++;
+	}
+	
+	return n;
+}
+
+// The first PDA_SIMD_MAX distinct characters of pairs
+template <size_t N>
+constexpr std::array<char, PDA_SIMD_MAX> pdaStaticNeedles(const std::array<char, N>& pairs, const std::array<unsigned int, 256>& cls)
+{
+	std::array<char, PDA_SIMD_MAX> out = {};
+	unsigned int n = 0;
+	
+	for(unsigned int i = 0; i < N && n < PDA_SIMD_MAX; i++)
+	{
+		if(cls[(unsigned char)pairs[i]] == i)
+			out[n++] = pairs[i];
+	}
+	
+	return out;
+}
+
+
+/************************************************
+ * String PDA with a delimiter set fixed at compile time
+ * e.g. StaticPDA<'\\', PDAPair<'{', '}'>, PDAPair<'"', '"'> >
+ * Delimiter indices match the pairs vector PDA<std::string> would be given
+ ************************************************/
+template <char Esc, typename... Pairs>
+class StaticPDA
+{
+	private:
+		/* Compiled delimiter set */
+		
+		// Number of entries in pairs
+		static constexpr unsigned int count = 1 + 2 * sizeof...(Pairs);
+		
+		// Escape in index 0, then each opening delimiter followed by its closing delimiter
+		static constexpr std::array<char, count> pairs = pdaStaticLayout<Esc, Pairs...>();
+		
+		// Class table, index of the first entry in pairs matching each byte (PDA_PLAIN if none)
+		static constexpr std::array<unsigned int, 256> cls = pdaStaticTable(pairs);
+		
+		// Distinct characters of pairs, searched for by skip()
+		static constexpr unsigned int needleCount = pdaStaticDistinct(pairs, cls);
+		static constexpr std::array<char, PDA_SIMD_MAX> needle = pdaStaticNeedles(pairs, cls);
+		
+		// Narrowest type that holds every index into pairs, used by the stack
+		typedef typename std::conditional<(count <= 256), unsigned char, typename std::conditional<(count <= 65536), unsigned short, unsigned int>::type>::type Index;
+		
+		// True if the opening delimiter at index i is its own closing delimiter
+		static constexpr bool symmetric(unsigned int i)
+		{
+			return i % 2 == 1 && i + 1 < count && pairs[i] == pairs[i + 1];
+		};
+		
+		/* State */
+		
+		std::string source;              // Source to read from when the PDA owns it
+		std::string_view ext;            // Source to read from when the caller owns it and keeps it alive
+		bool borrowed;                   // True if reading from ext instead of source
+		PDAStack<Index> stack;           // Stack used to keep track of delimiter pairs, array of indices into pairs
+		size_t maxDepth;                 // Most delimiters the stack may hold, opening one more is an error
+		size_t start;                    // Starting position of valid token
+		size_t pos;                      // Current read position of PDA
+		bool esc;                        // True if an escape character was found
+		
+		bool noisy;                      // push() and pop() output to command line when set
+		
+		// Error checking
+		// < 0 means error, do not continue
+		int err;
+		
+		// Index of last opening delimiter popped
+		unsigned int odelim;
+		
+		/*******************************************
+		 * Private Functions
+		 *******************************************/
+		
+		// Get the source being read, whoever owns it
+		std::string_view src()
+		{
+			if(this->borrowed)
+				return this->ext;
+			
+			return std::string_view(this->source);
+		};
+		
+		/* Stack manipulation */
+		
+		// Add index of a delimiter to the stack
+		void push(unsigned int index)
+		{
+			this->stack.push_back(index);
+			
+			if(this->noisy)
+			{
+				std::cout << "after push at " << this->pos << " [";
+				for(size_t i = 0; i < this->stack.size(); i++)
+				{
+					std::cout << this->stack[i] << ", ";
+				}
+				std::cout << "]\n";
+			}
+		};
+		
+		// Remove index of a delimiter from the stack when its complement is found
+		void pop()
+		{
+			this->odelim = this->stack.back();
+			this->stack.pop_back();
+			
+			if(this->noisy)
+			{
+				std::cout << "after pop at " << this->pos << " [";
+				for(size_t i = 0; i < this->stack.size(); i++)
+				{
+					std::cout << this->stack[i] << ", ";
+				}
+				std::cout << "]\n";
+			}
+		};
+		
+		/* Transitions */
+		
+		// Move past the current character, reporting unclosed delimiters at the end of the source
+		void advance(size_t n)
+		{
+			this->pos += n;
+			if(this->pos >= this->src().length() && this->stack.size() > 0)
+			{
+				// Unclosed delimiter error
+				this->err = this->noCloseErr();
+			}
+		};
+		
+		// Read next element from source and move the automata along
+		// Returns true if a delimiter closed a token, which is then source[from, from + len)
+		bool step(size_t& from, size_t& len)
+		{
+			// Do not proceed if error code is set or end of source is reached
+			if(this->err < 0 || this->pos >= this->src().length())
+				return false;
+			
+			// Reset the last opening delimiter popped, assuming that the user has already accessed it
+			this->odelim = 0;
+			
+			// There's nothing to do if this character is escaped
+			if(this->esc)
+			{
+				this->esc = false;
+				this->advance(1);
+				return false;
+			}
+			
+			unsigned int i = cls[(unsigned char)this->src()[this->pos]];
+			
+			// There's nothing to do if this is a plain character
+			if(i == PDA_PLAIN)
+			{
+				this->advance(1);
+				return false;
+			}
+			
+			// There's nothing to do if this is an escape character
+			if(i == 0)
+			{
+				this->esc = true;
+				this->advance(1);
+				return false;
+			}
+			
+			if(i % 2 == 1) // Opening delimiter
+			{
+				// A symmetric delimiter on top of the stack closes its block
+				if( symmetric(i) && this->stack.size() > 0 && this->stack.back() == i )
+				{
+					this->pop();
+				}
+				else if( this->stack.size() >= this->maxDepth )
+				{
+					// Nesting past the maximum depth
+					this->err = this->tooDeepErr(pairs[i]);
+					return false;
+				}
+				else
+				{
+					this->push(i);
+				}
+			}
+			else           // Closing delimiter
+			{
+				if( this->stack.size() == 0 )
+				{
+					// No opening delimiters found on the stack
+					this->err = this->noStartErr(pairs[i]);
+					return false;
+				}
+				
+				if( this->stack.back() != i - 1 )
+				{
+					// This closing delimiter does not match the one found on top of the stack
+					this->err = this->mismatchErr(pairs[this->stack.back()], pairs[i]);
+					return false;
+				}
+				
+				this->pop();
+				
+				// Save last index to be popped
+				this->odelim = i - 1;
+			}
+			
+			// Mark the token and move start past the delimiter
+			from = this->start;
+			len = this->pos - this->start;
+			this->start = this->pos + 1;
+			
+			this->advance(1);
+			return true;
+		};
+		
+		// Skip to the next escape or delimiter character, then step over it
+		bool stepDelim(size_t& from, size_t& len)
+		{
+			// An escaped character is consumed like any other
+			if(this->esc)
+				this->step(from, len);
+			
+			this->skip();
+			return this->step(from, len);
+		};
+		
+		// Set up everything but the source, shared by the constructors
+		void init(bool n)
+		{
+			this->noisy = n;
+			this->maxDepth = PDA_MAX_DEPTH;
+			this->start = 0;
+			this->pos = 0;
+			this->esc = false;
+			this->err = 0;
+			this->odelim = 0;
+		};
+	
+	public:
+		/* Constructors */
+		
+		// Read a copy of src, or take it over without copying when it is moved in
+		StaticPDA(std::string src, bool n)
+		{
+			this->source = std::move(src);
+			this->borrowed = false;
+			this->init(n);
+		};
+		
+		// Read a copy of a null-terminated string
+		StaticPDA(const char* src, bool n)
+		{
+			this->source = src;
+			this->borrowed = false;
+			this->init(n);
+		};
+		
+		// Read src in place without copying it; the caller must keep it alive while the PDA is in use
+		StaticPDA(std::string_view src, bool n)
+		{
+			this->ext = src;
+			this->borrowed = true;
+			this->init(n);
+		};
+		
+		// Read len characters from src in place without copying them; the caller must keep them alive while the PDA is in use
+		StaticPDA(const char* src, size_t len, bool n)
+		{
+			this->ext = std::string_view(src, len);
+			this->borrowed = true;
+			this->init(n);
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		/* Traverse automata */
+		
+		// Read next element from source
+		std::string readNext()
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+				return std::string(this->src().substr(from, len));
+			
+			return std::string();
+		};
+		
+		// Read next element from source, giving the token as a view into source instead of a copy
+		std::string_view readNextView()
+		{
+			size_t from, len;
+			
+			if(this->step(from, len))
+				return this->src().substr(from, len);
+			
+			return std::string_view();
+		};
+		
+		// Skip ahead over characters that are neither the escape nor a delimiter
+		// Leaves the automata where the same number of readNext() calls would have, and returns the number of characters skipped
+		size_t skip()
+		{
+			// Do not proceed if error code is set, end of source is reached or the next character is escaped
+			if(this->err < 0 || this->pos >= this->src().length() || this->esc)
+				return 0;
+			
+			const char* s = this->src().data() + this->pos;
+			size_t len = this->src().length() - this->pos;
+			size_t n = 0;
+			
+			if(needleCount <= PDA_SIMD_MAX)
+			{
+				n = pdaFindAny(s, len, needle.data(), needleCount);
+			}
+			else
+			{
+				while(n < len && cls[(unsigned char)s[n]] == PDA_PLAIN)
+				{
+					n++;
+				}
+			}
+			
+			if(n > 0)
+			{
+				// readNext() would have reset the last opening delimiter popped
+				this->odelim = 0;
+				this->advance(n);
+			}
+			
+			return n;
+		};
+		
+		// Read up to and including the next escape or delimiter character
+		// Returns the token that calling readNext() on every character up to that point would have
+		std::string readNextDelim()
+		{
+			size_t from, len;
+			
+			if(this->stepDelim(from, len))
+				return std::string(this->src().substr(from, len));
+			
+			return std::string();
+		};
+		
+		// Same as readNextDelim(), giving the token as a view into source instead of a copy
+		std::string_view readNextDelimView()
+		{
+			size_t from, len;
+			
+			if(this->stepDelim(from, len))
+				return this->src().substr(from, len);
+			
+			return std::string_view();
+		};
+		
+		/* Bulk tokenizing */
+		
+		// Read the rest of the source in one pass, adding a row to out for every token readNext() would have given
+		// Rows are appended, so clear() out first unless it should keep the rows of earlier calls
+		// Stops where readNext() would; returns the number of rows added, check getErr() afterwards
+		size_t tokenizeAll(PDATokenTable& out)
+		{
+			size_t rows = out.size();
+			size_t from, len;
+			
+			while(this->err >= 0 && this->pos < this->src().length())
+			{
+				size_t depth = this->stack.size();
+				
+				if(this->stepDelim(from, len))
+				{
+					// The delimiter that ended the token is the last character read
+					out.push_back(from, len, cls[(unsigned char)this->src()[this->pos - 1]], this->stack.size(), this->stack.size() > depth);
+				}
+			}
+			
+			return out.size() - rows;
+		};
+		
+		/* Events */
+		
+		// Read the rest of the source in one pass, calling h for every event instead of being polled after each readNext()
+		// Handler is usually derived from PDAHandler; its calls are resolved at compile time
+		// Stops where readNext() would, calling h.onError() if it stopped on an error; returns the error code
+		template <typename Handler>
+		int parse(Handler& h)
+		{
+			size_t from, len;
+			
+			while(this->err >= 0 && this->pos < this->src().length())
+			{
+				this->skip();
+				if(this->err < 0 || this->pos >= this->src().length())
+					break;
+				
+				size_t at = this->pos;
+				size_t depth = this->stack.size();
+				bool escaped = this->esc;
+				
+				if(this->step(from, len))
+				{
+					h.onToken(this->src().substr(from, len));
+					
+					if(this->stack.size() > depth)
+						h.onOpen(cls[(unsigned char)this->src()[at]], at);
+					else
+						h.onClose(cls[(unsigned char)this->src()[at]], at);
+				}
+				else if(this->esc && !escaped)
+				{
+					h.onEscape(at);
+				}
+			}
+			
+			if(this->err < 0)
+				h.onError(this->err, this->pos);
+			
+			return this->err;
+		}
+		
+		/* Reporting */
+		
+		// Get current position of automata
+		size_t getPos()
+		{
+			return this->pos;
+		};
+		
+		// Get error code
+		int getErr()
+		{
+			return this->err;
+		};
+		
+		// Get the index of the last delimiter to be pushed onto the stack
+		// 0 if the stack is empty
+		unsigned int lastDelim()
+		{
+			if(this->stack.size() > 0)
+				return this->stack.back();
+			else
+				return 0;
+		};
+		
+		// Get the index of the last delimiter to be removed from the stack
+		unsigned int lastRemoved()
+		{
+			return this->odelim;
+		};
+		
+		// Get the depth of the stack
+		size_t stackDepth()
+		{
+			return this->stack.size();
+		};
+		
+		// Set the most delimiters the stack may hold; opening one more stops the automata with a too deep error
+		void setMaxDepth(size_t depth)
+		{
+			this->maxDepth = depth;
+		};
+		
+		// Get the most delimiters the stack may hold
+		size_t getMaxDepth()
+		{
+			return this->maxDepth;
+		};
+		
+		// Check if escape character flag is set
+		bool isEsc()
+		{
+			return this->esc;
+		};
+		
+		// Get a portion of source from this->start to this->pos
+		// Update start if update == true
+		std::string getPortion(bool update)
+		{
+			return std::string(this->getPortionView(update));
+		};
+		
+		// Same as getPortion(), giving the portion as a view into source instead of a copy
+		std::string_view getPortionView(bool update)
+		{
+			std::string_view out = this->src().substr(this->start, this->pos - this->start);
+			
+			// Update start if necessary
+			if(update)
+			{
+				this->start = this->pos + 1;
+			}
+			
+			return out;
+		};
+		
+		// Report starting delimiter missing
+		int noStartErr(char close)
+		{
+			std::cout << "[Error] Non-escaped delimiter " << close << " has no starting complement\n";
+			
+			return -1;
+		};
+		
+		// Report closing delimiter missing
+		int noCloseErr()
+		{
+			std::cout << "[Error] Non-escaped delimiter(s) [ ";
+			for(size_t i = 0; i < this->stack.size(); i++)
+			{
+				std::cout << pairs[this->stack[i]] << " ";
+			}
+			std::cout << "] do(es) not have a closing complement\n";
+			
+			return -2;
+		};
+		
+		// Report starting/closing delimiter pair mismatch
+		int mismatchErr(char open, char close)
+		{
+			std::cout << "[Error] Starting delimiter " << open << " does not pair with closing delimiter " << close << "\n";
+			
+			return -3;
+		};
+		
+		// Report nesting past the maximum depth
+		int tooDeepErr(char open)
+		{
+			std::cout << "[Error] Delimiter " << open << " nests deeper than the maximum depth of " << this->maxDepth << "\n";
+			
+			return -4;
+		};
+};
+
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef PDA_TREE_H
+#define PDA_TREE_H
+
+
+/************************************************
+ * Block of a PDABlockTree
+ * Links are indices into the tree's arena, PDABlockTree::npos if there is none
+ ************************************************/
+class PDABlock
+{
+	public:
+		unsigned int delim;              // Index into pairs of the opening delimiter
+		pdaOffset start;                 // Position of the opening delimiter
+		pdaOffset end;                   // Position of the closing delimiter, npos if the block was never closed
+		pdaOffset child;                 // First block inside this one
+		pdaOffset sibling;               // Next block inside the same parent
+};
+
+
+/************************************************
+ * Tree of the blocks opened and closed while parsing
+ * Pass it to parse() as the handler: PDABlockTree t; pda.parse(t);
+ * Blocks live in one array in the order they were opened, which is depth first order,
+ * so the tree is walked by going through the array and freed all at once by clear()
+ ************************************************/
+class PDABlockTree : public PDAHandler
+{
+	private:
+		std::vector<PDABlock> nodes;     // Every block, in the order they were opened
+		std::vector<pdaOffset> open;     // Blocks still open, innermost last
+		std::vector<pdaOffset> last;     // Last child added to each block in open, npos if none yet
+		pdaOffset top;                   // Last block added at the top level, npos if none yet
+	
+	public:
+		// Link to no block
+		static constexpr pdaOffset npos = (pdaOffset)-1;
+		
+		/* Constructor */
+		PDABlockTree()
+		{
+			this->top = npos;
+		};
+		
+		/*******************************************
+		 * Events, see PDAHandler
+		 *******************************************/
+		
+		// Add a block as the last child of the innermost open block
+		void onOpen(unsigned int delim, size_t pos)
+		{
+			pdaOffset i = (pdaOffset)this->nodes.size();
+			PDABlock b;
+			
+			b.delim = delim;
+			b.start = (pdaOffset)pos;
+			b.end = npos;
+			b.child = npos;
+			b.sibling = npos;
+			this->nodes.push_back(b);
+			
+			// Link it after the previous child, or as the first one
+			pdaOffset& prev = this->open.empty() ? this->top : this->last.back();
+			if(prev != npos)
+				this->nodes[prev].sibling = i;
+			else if(!this->open.empty())
+				this->nodes[this->open.back()].child = i;
+			prev = i;
+			
+			this->open.push_back(i);
+			this->last.push_back(npos);
+		};
+		
+		// Close the innermost open block
+		void onClose(unsigned int /*delim*/, size_t pos)
+		{
+			this->nodes[this->open.back()].end = (pdaOffset)pos;
+			this->open.pop_back();
+			this->last.pop_back();
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Remove every block, keeping the arena for the next parse
+		void clear()
+		{
+			this->nodes.clear();
+			this->open.clear();
+			this->last.clear();
+			this->top = npos;
+		};
+		
+		// Get block i
+		const PDABlock& operator[](size_t i) const
+		{
+			return this->nodes[i];
+		};
+		
+		// Get the first block at the top level, npos if there is none
+		// Later top level blocks follow it through sibling
+		pdaOffset root() const
+		{
+			return this->nodes.empty() ? npos : 0;
+		};
+		
+		// Get the number of blocks
+		size_t size() const
+		{
+			return this->nodes.size();
+		};
+		
+		// Get every block, in depth first order
+		const PDABlock* begin() const
+		{
+			return this->nodes.data();
+		};
+		
+		const PDABlock* end() const
+		{
+			return this->nodes.data() + this->nodes.size();
+		};
+};
+
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef PDA_UTF8_H
+#define PDA_UTF8_H
+
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include "pda_grammar.h"
+
+// Bytes per block of PDAUtf8Offsets, each block keeping a count of the code points before it
+#ifndef PDA_UTF8_BLOCK
+	#define PDA_UTF8_BLOCK 4096
+#endif
+
+
+/************************************************
+ * UTF-8 sources, read as bytes by PDA<std::string>
+ * A delimiter given as a code point is compiled into the bytes that encode it,
+ * so the grammar's search looks for lead bytes and ASCII directly in the source
+ * A byte that continues a code point never starts one, so a delimiter only matches on a whole code point
+ * and everything is reported in byte offsets; PDAUtf8Offsets turns them into code point offsets
+ ************************************************/
+
+// Add the UTF-8 encoding of code point c to out
+// Returns false, adding nothing, for surrogates and values past U+10FFFF
+inline bool pdaAppendUtf8(std::string& out, char32_t c)
+{
+	if(c < 0x80)
+	{
+		out += (char)c;
+	}
+	else if(c < 0x800)
+	{
+		out += (char)(0xC0 | (c >> 6));
+		out += (char)(0x80 | (c & 0x3F));
+	}
+	else if(c >= 0xD800 && c < 0xE000)
+	{
+		return false;
+	}
+	else if(c < 0x10000)
+	{
+		out += (char)(0xE0 | (c >> 12));
+		out += (char)(0x80 | ((c >> 6) & 0x3F));
+		out += (char)(0x80 | (c & 0x3F));
+	}
+	else if(c < 0x110000)
+	{
+		out += (char)(0xF0 | (c >> 18));
+		out += (char)(0x80 | ((c >> 12) & 0x3F));
+		out += (char)(0x80 | ((c >> 6) & 0x3F));
+		out += (char)(0x80 | (c & 0x3F));
+	}
+	else
+	{
+		return false;
+	}
+	
+	return true;
+}
+
+// Compile delimiters of any number of code points into a grammar over UTF-8 bytes, e.g. {U"\\", U"«", U"»", U"【", U"】"}
+// q holds the indices of the opening delimiters of quoted pairs, as for PDAGrammar
+// A delimiter that cannot be encoded is reported and left empty, so it matches nothing but keeps its index
+inline PDAGrammar<char> pdaUtf8Grammar(const std::vector<std::u32string>& p, std::vector<unsigned int> q = std::vector<unsigned int>())
+{
+	std::vector<std::string> d(p.size());
+	
+	for(size_t i = 0; i < p.size(); i++)
+	{
+		for(size_t k = 0; k < p[i].length(); k++)
+		{
+			if(!pdaAppendUtf8(d[i], p[i][k]))
+			{
+				std::cout << "[Error] Delimiter " << i << " holds U+" << std::hex << (unsigned long)p[i][k] << std::dec << ", which is not a code point UTF-8 can encode\n";
+				d[i].clear();
+				break;
+			}
+		}
+	}
+	
+	return PDAGrammar<char>(std::move(d), std::move(q));
+}
+
+// One code point per delimiter, e.g. {U'\\', U'«', U'»'}
+inline PDAGrammar<char> pdaUtf8Grammar(const std::vector<char32_t>& p, std::vector<unsigned int> q = std::vector<unsigned int>())
+{
+	std::vector<std::u32string> d;
+	
+	d.reserve(p.size());
+	for(size_t i = 0; i < p.size(); i++)
+	{
+		d.push_back(std::u32string(1, p[i]));
+	}
+	
+	return pdaUtf8Grammar(d, std::move(q));
+}
+
+
+/************************************************
+ * Code point offsets of a UTF-8 source, worked out only as far as they are asked for
+ * Code points are counted PDA_UTF8_BLOCK bytes at a time, so a lookup reads at most one block
+ * past the counts already kept; the caller must keep the source alive
+ ************************************************/
+class PDAUtf8Offsets
+{
+	private:
+		std::string_view source;         // Source the offsets are into
+		std::vector<size_t> counts;      // Code points before each block counted so far, counts[0] being 0
+		
+		// Count blocks until block b has a count
+		void reach(size_t b)
+		{
+			while(this->counts.size() <= b)
+			{
+				size_t k = this->counts.size() - 1;
+				this->counts.push_back(this->counts.back() + pdaCountUtf8(this->source.data() + k * PDA_UTF8_BLOCK, PDA_UTF8_BLOCK));
+			}
+		};
+	
+	public:
+		/* Constructor */
+		PDAUtf8Offsets(std::string_view src)
+		{
+			this->source = src;
+			this->counts.push_back(0);
+		};
+		
+		/*******************************************
+		 * Functions
+		 *******************************************/
+		
+		// Get the number of code points starting before byte offset b
+		// A byte offset partway through a code point counts that code point
+		size_t codePoint(size_t b)
+		{
+			if(b > this->source.length())
+				b = this->source.length();
+			
+			size_t k = b / PDA_UTF8_BLOCK;
+			this->reach(k);
+			
+			return this->counts[k] + pdaCountUtf8(this->source.data() + k * PDA_UTF8_BLOCK, b - k * PDA_UTF8_BLOCK);
+		};
+		
+		// Get the byte offset of code point c, the length of the source if there are not that many
+		size_t byteOf(size_t c)
+		{
+			// Count blocks until one ends past c, or the source does
+			size_t blocks = this->source.length() / PDA_UTF8_BLOCK;
+			while(this->counts.size() <= blocks && this->counts.back() <= c)
+			{
+				this->reach(this->counts.size());
+			}
+			
+			// The last block with at most c code points before it
+			size_t k = std::upper_bound(this->counts.begin(), this->counts.end(), c) - this->counts.begin() - 1;
+			
+			// Then walk that block to the lead byte of c
+			size_t n = this->counts[k];
+			for(size_t b = k * PDA_UTF8_BLOCK; b < this->source.length(); b++)
+			{
+				if(((unsigned char)this->source[b] & 0xC0) != 0x80)
+				{
+					if(n == c)
+						return b;
+					n++;
+				}
+			}
+			
+			return this->source.length();
+		};
+		
+		// Forget the counts, for a source that has changed
+		void reset(std::string_view src)
+		{
+			this->source = src;
+			this->counts.assign(1, 0);
+		};
+};
+
+
+#endif